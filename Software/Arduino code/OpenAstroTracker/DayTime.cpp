@@ -8,151 +8,125 @@
 // addition of hours, minutes, seconds, other times and conversion to string.
 
 DayTime::DayTime() {
-  hours = 0;
-  mins = 0;
-  secs = 0;
+  units = 0;
 }
 
 DayTime::DayTime(const DayTime& other) {
-  hours = other.hours;
-  mins = other.mins;
-  secs = other.secs;
+  units = other.units;
 }
 
 DayTime::DayTime(int h, int m, int s) {
-  hours = h;
-  mins = m;
-  secs = s;
+  units = h * TIME_UNITS_PER_HOUR + m * TIME_UNITS_PER_MINUTE + s * TIME_UNITS_PER_SECOND;
 }
 
 // From milliseconds. Does not handle days!
 DayTime::DayTime(long ms) {
-  ms /= 1000; // seconds
-  secs = (int)(ms % 60);
-  ms = (ms - secs) / 60;
-  mins = (int)(ms % 60);
-  ms = (ms - mins) / 60;
-  hours = (int)ms;
+  units = ms / (1000L / TIME_UNITS_PER_SECOND);
 }
 
 DayTime::DayTime(float timeInHours) {
-  hours = floor(timeInHours);
-  timeInHours = (timeInHours - hours) * 60;
-  mins = floor(timeInHours);
-  timeInHours = (timeInHours - mins) * 60;
-  secs = floor(timeInHours);
+  units = (long)floor(timeInHours * TIME_UNITS_PER_HOUR + 0.5f);
 }
 
 int DayTime::getHours() const {
-  return hours;
+  // Round down, so that the minutes and seconds are positive for negative times as well.
+  long h = units / TIME_UNITS_PER_HOUR;
+  if ((units < 0) && (h * TIME_UNITS_PER_HOUR != units)) {
+    h--;
+  }
+  return (int)h;
 }
 
 int DayTime::getMinutes() const {
-  return mins;
+  return (int)((units - getHours() * TIME_UNITS_PER_HOUR) / TIME_UNITS_PER_MINUTE);
 }
 
 int DayTime::getSeconds() const {
-  return secs;
+  return (int)((units - getHours() * TIME_UNITS_PER_HOUR) % TIME_UNITS_PER_MINUTE / TIME_UNITS_PER_SECOND);
+}
+
+long DayTime::getTotalUnits() const {
+  return units;
+}
+
+void DayTime::setTotalUnits(long totalUnits) {
+  units = totalUnits;
+  checkHours();
 }
 
 float DayTime::getTotalHours() const {
-  return 1.0f * getHours() + ((float)getMinutes() / 60.0f) + ((float)getSeconds() / 3600.0f);
+  return units / (float)TIME_UNITS_PER_HOUR;
 }
 
 float DayTime::getTotalMinutes() const {
-  return 60.0f * getHours() + (float)getMinutes() + ((float)getSeconds() / 60.0f);
+  return units / (float)TIME_UNITS_PER_MINUTE;
 }
 
 float DayTime::getTotalSeconds() const {
-  return 3600.0f * getHours() + (float)getMinutes() * 60.0f + (float)getSeconds();
+  return units / (float)TIME_UNITS_PER_SECOND;
 }
 
 int DayTime::getTime(int& h, int& m, int& s) const {
-  h = hours;
-  m = mins;
-  s = secs;
+  h = getHours();
+  m = getMinutes();
+  s = getSeconds();
 }
 
 void DayTime::set(int h, int m, int s) {
-  hours = h;
-  mins = m;
-  secs = s;
+  units = h * TIME_UNITS_PER_HOUR + m * TIME_UNITS_PER_MINUTE + s * TIME_UNITS_PER_SECOND;
   checkHours();
 }
 
 void DayTime::set(const DayTime& other) {
-  hours = other.hours;
-  mins = other.mins;
-  secs = other.secs;
+  units = other.units;
   checkHours();
 }
 
 // Add hours, wrapping days (which are not tracked)
 void DayTime::addHours(int deltaHours) {
-  hours += deltaHours;
+  units += deltaHours * TIME_UNITS_PER_HOUR;
   checkHours();
 }
 
 void DayTime::checkHours() {
-  while (hours >= hourWrap) {
-    hours -= hourWrap;
-  }
-
-  while (hours < 0) {
-    hours += hourWrap;
+  const long unitsPerDay = 24L * TIME_UNITS_PER_HOUR;
+  units %= unitsPerDay;
+  if (units < 0) {
+    units += unitsPerDay;
   }
 }
 
 // Add minutes, wrapping hours if needed
 void DayTime::addMinutes(int deltaMins) {
-  mins += deltaMins;
-  while (mins > 59) {
-    mins -= 60;
-    addHours(1);
-  }
-
-  while (mins < 0) {
-    mins += 60;
-    addHours(-1);
-  }
+  units += deltaMins * TIME_UNITS_PER_MINUTE;
+  checkHours();
 }
 
 // Add seconds, wrapping minutes and hours if needed
 void DayTime::addSeconds(long deltaSecs) {
-  secs += deltaSecs;
-  while (secs > 59) {
-    secs -= 60;
-    addMinutes(1);
-  }
-
-  while (secs < 0) {
-    secs += 60;
-    addMinutes(-1);
-  }
+  units += deltaSecs * TIME_UNITS_PER_SECOND;
+  checkHours();
 }
 
 // Add time components, wrapping seconds, minutes and hours if needed
 void DayTime::addTime(int deltaHours, int deltaMinutes, int deltaSeconds)
 {
-  addSeconds(deltaSeconds);
-  addMinutes(deltaMinutes);
-  addHours(deltaHours);
+  units += deltaHours * TIME_UNITS_PER_HOUR + deltaMinutes * TIME_UNITS_PER_MINUTE + deltaSeconds * TIME_UNITS_PER_SECOND;
+  checkHours();
 }
 
 // Add another time, wrapping seconds, minutes and hours if needed
 void DayTime::addTime(const DayTime& other)
 {
-  addSeconds(other.getSeconds());
-  addMinutes(other.getMinutes());
-  addHours(other.getHours());
+  units += other.units;
+  checkHours();
 }
 
 // Subtract another time, wrapping seconds, minutes and hours if needed
 void DayTime::subtractTime(const DayTime& other)
 {
-  addSeconds(-other.getSeconds());
-  addMinutes(-other.getMinutes());
-  addHours(-other.getHours());
+  units -= other.units;
+  checkHours();
 }
 
 // Convert to a standard string (like 14:45:06)
@@ -160,6 +134,9 @@ String DayTime::ToString()
 {
   char achBuf[12];
   char* p = achBuf;
+  int hours = getHours();
+  int mins = getMinutes();
+  int secs = getSeconds();
 
   if (hours < 10) {
     *p++ = '0';
@@ -193,10 +170,7 @@ String DayTime::ToString()
 }
 
 
-DegreeTime::DegreeTime() : DayTime() {
-  hourWrap = 180;
-}
-
+DegreeTime::DegreeTime() : DayTime() { }
 DegreeTime::DegreeTime(const DegreeTime& other) : DayTime(other) { }
 DegreeTime::DegreeTime(int h, int m, int s) : DayTime(h, m, s) { }
 DegreeTime::DegreeTime(float inDegrees) : DayTime(inDegrees) { }
@@ -206,11 +180,11 @@ void DegreeTime::addDegrees(int deltaDegrees) {
 }
 
 int DegreeTime::getDegrees() {
-  return hours;
+  return getHours();
 }
 
 int DegreeTime::getPrintDegrees() {
-  return NORTHERN_HEMISPHERE ? hours + 90 : hours - 90;
+  return NORTHERN_HEMISPHERE ? getHours() + 90 : getHours() - 90;
 }
 
 float DegreeTime::getTotalDegrees() {
@@ -218,12 +192,11 @@ float DegreeTime::getTotalDegrees() {
 }
 
 void DegreeTime::checkHours() {
+  const long unitsPerHalfTurn = 180L * TIME_UNITS_PER_HOUR;
   if (NORTHERN_HEMISPHERE) {
-    if (hours > 0) hours = 0;
-    if (hours < -180) hours = -180;
+    units = clamp(units, -unitsPerHalfTurn, 0L);
   }
   else {
-    if (hours > 180) hours = 180;
-    if (hours < 0) hours = 0;
+    units = clamp(units, 0L, unitsPerHalfTurn);
   }
 }
@@ -6,13 +6,20 @@
 
 // A class to handle hours, minutes, seconds in a unified manner, allowing
 // addition of hours, minutes, seconds, other times and conversion to string.
+//
+// The time is kept as a single fixed point number of hundredths of a second (of time for DayTime, of arc
+// for DegreeTime), so adding and wrapping take a few integer operations, however large the change. It is
+// only split into hours, minutes and seconds when those are asked for, which is mostly for formatting.
+// Like before, the hours can be negative, but the minutes and seconds are always added on (so -40:30:00
+// is -39.5 hours).
+
+#define TIME_UNITS_PER_SECOND 100L
+#define TIME_UNITS_PER_MINUTE (60L * TIME_UNITS_PER_SECOND)
+#define TIME_UNITS_PER_HOUR (3600L * TIME_UNITS_PER_SECOND)
 
 class DayTime {
 protected:
-  int hours;
-  int mins;
-  int secs;
-  int hourWrap = 24;
+  long units;
 
 public:
   DayTime();
@@ -29,6 +36,10 @@ public:
   int getHours() const;
   int getMinutes() const;
   int getSeconds() const;
+
+  // Get or set the time in hundredths of a second.
+  long getTotalUnits() const;
+  void setTotalUnits(long totalUnits);
   float getTotalHours() const;
   float getTotalMinutes() const;
   float getTotalSeconds() const;
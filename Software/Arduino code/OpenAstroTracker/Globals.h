@@ -6,9 +6,47 @@
 // Set to 1 if you are in the northern hemisphere.
 #define NORTHERN_HEMISPHERE 1
 
+// Which version of the RA ring you printed. Uncomment one of the two following lines. The steps per degree
+// of each version are in MountGeometry.hpp.
+// #define RA_RING_VERSION 1      // V1 Ring has a ridge on top of the ring that the belt runs on and the ring runs on the bearings
+// #define RA_RING_VERSION 2      // V2 Ring has belt in a groove and belt runs on bearings
+
+// Belt moves 40mm for one stepper revolution (2mm pitch, 20 teeth).
+// DEC wheel is 2 x PI x 90mm circumference which is 565.5mm
+// One DEC revolution needs 14.13 (565.5mm/40mm) stepper revolutions
+// Which means 57907 steps (14.14 x 4096) moves 360 degrees
+// So there are 160.85 steps/degree (57907/360)
+#define DEC_STEPS_PER_DEGREE 161     // Number of steps needed to move DEC motor 1 degree.
+
+// You can change the speed (steps/s) and acceleration (steps/s/s) of the steppers here. Max. Speed = 1200.
+// High speeds tend to make these cheap steppers unprecice
+#define RA_MAX_SPEED 800
+#define RA_ACCELERATION 1200
+#define DEC_MAX_SPEED 800
+#define DEC_ACCELERATION 400
+
+// How many hours past the meridian (6 hours from home) a target can be before a slew goes to the other side of the pier.
+// Slews pick the quickest side that is within this and the limits (see OpenAstroTracker.ino), so a target just past
+// the meridian can stay on the same side and be tracked through it.
+#define MERIDIAN_FLIP_HYSTERESIS 0.25f
+
 // Time in ms between LCD screen updates during slewing operations
 #define DISPLAY_UPDATE_TIME 200
 
+// Uncomment to accelerate slews along a smooth S-curve instead of at a constant rate. This
+// takes a little longer, but starts and stops the motors more gently.
+// #define SLEW_S_CURVE
+
+// Which driver boards the steppers are connected to. DRIVER_ULN2003 is the 4-wire board that comes with the 28BYJ-48.
+// DRIVER_STEPDIR is a step/dir board (A4988, DRV8825, TMC2209, ...), set up to do RA_MICROSTEPS (or DEC_MICROSTEPS)
+// per full step. The pins are in a_inits.ino. For step/dir drivers, the steps per degree above are
+// full steps of the motor, and you may want to run the step timer faster (see STEP_TIMER_FREQUENCY) for faster slews.
+#define RA_DRIVER DRIVER_ULN2003
+#define DEC_DRIVER DRIVER_ULN2003
+#define RA_MICROSTEPS 16
+#define DEC_MICROSTEPS 16
+// #define STEP_TIMER_FREQUENCY 10000
+
 // Make some variables in the sketch files available to the C++ code.
 extern bool inSerialControl;
 
@@ -62,6 +100,23 @@ extern bool inSerialControl;
 // Uncomment to support Serial Meade LX200 protocol support
 // #define SUPPORT_SERIAL_CONTROL
 
+// Uncomment to support Periodic Error Correction. Guide pulses are recorded over a few turns of the
+// RA motor and then played back as tracking speed corrections. Uses about 200 bytes of data memory.
+// #define SUPPORT_PEC
+
+// Uncomment to support the King tracking rate (:TK#), which follows the stars as refraction shows them. RA and
+// DEC tracking rates are worked out for where the mount points every few seconds, from the site latitude.
+// #define SUPPORT_KING_RATE
+
+// Uncomment to move J2000 coordinates (:Sr,J# and :Sd,J#, the POI menu and Polaris) to the date with precession,
+// nutation and aberration, to about an arcsecond. Without it, only the yearly precession rates are used, which is
+// good to an arcminute or two. Uses about 50 bytes of data memory.
+// #define SUPPORT_PRECESSION
+
+// Uncomment to support the alignment model (:CA#, :CC# and :GIA#). From the second alignment star on, slews are
+// corrected for polar misalignment, and from the third on for cone error. Uses about 110 bytes of data memory.
+// #define SUPPORT_ALIGNMENT
+
 
 // If we are making a headleass (no screen, no keyboard) client, always enable Serial.
 #ifdef HEADLESS_CLIENT
@@ -0,0 +1,671 @@
+#include "InterruptStepper.hpp"
+
+#define MODE_IDLE     0
+#define MODE_SPEED    1
+#define MODE_POSITION 2
+
+// Conversion factor from steps/s to 0.32 fixed point steps/tick.
+const float stepsPerSecondToRate = 4294967296.0f / STEP_TIMER_FREQUENCY;
+
+// The rate at which backlash is taken up.
+const uint32_t backlashRate = (uint32_t)(4294967296.0 * BACKLASH_SPEED / STEP_TIMER_FREQUENCY);
+
+#ifdef DEBUG_MODE
+volatile unsigned long InterruptStepper::_maxTickDuration = 0;
+#endif
+
+/////////////////////////////////
+//
+// CTOR
+//
+/////////////////////////////////
+InterruptStepper::InterruptStepper() {
+  _mode = MODE_IDLE;
+  _direction = 1;
+  _position = 0;
+  _target = 0;
+  _rate = 0;
+  _accumulator = 0;
+  _maxSpeed = 0;
+  _acceleration = 0;
+  _rampChanged = true;
+  _rampLevel = 0;
+  _rampTravel = 0;
+  _trackingPosition = 0;
+  _trackingRate = 0;
+  _trackingBaseRate = 0;
+  _trackingDirection = 1;
+  _trackingCorrection = NULL;
+  _correctionShift = CORRECTION_STEP_BITS;
+  _motorPosition = 0;
+  _trackingAccumulator = 0;
+  _backlash = 0;
+  _backlashOffset = 0;
+  _motorDirection = 1;
+  _pendingSteps = 0;
+  _backlashAccumulator = 0;
+  _limitLow = -NO_LIMIT;
+  _limitHigh = NO_LIMIT;
+}
+
+/////////////////////////////////
+//
+// startTimer
+//
+// Runs Timer1 in CTC mode with a prescaler of 8, interrupting at STEP_TIMER_FREQUENCY.
+/////////////////////////////////
+void InterruptStepper::startTimer() {
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = (1 << WGM12) | (1 << CS11);
+  OCR1A = (F_CPU / 8 / STEP_TIMER_FREQUENCY) - 1;
+  TCNT1 = 0;
+  TIMSK1 |= (1 << OCIE1A);
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// setMaxSpeed
+//
+/////////////////////////////////
+void InterruptStepper::setMaxSpeed(float stepsPerSecond) {
+  // We can do at most one step per tick.
+  stepsPerSecond = min(fabs(stepsPerSecond), STEP_TIMER_FREQUENCY - 1.0f);
+  if (stepsPerSecond != _maxSpeed) {
+    _maxSpeed = stepsPerSecond;
+    _rampChanged = true;
+  }
+}
+
+/////////////////////////////////
+//
+// setAcceleration
+//
+/////////////////////////////////
+void InterruptStepper::setAcceleration(float stepsPerSecondPerSecond) {
+  stepsPerSecondPerSecond = fabs(stepsPerSecondPerSecond);
+  if (stepsPerSecondPerSecond != _acceleration) {
+    _acceleration = stepsPerSecondPerSecond;
+    _rampChanged = true;
+  }
+}
+
+/////////////////////////////////
+//
+// calculateRamp
+//
+// Splits the time it takes to get to the maximum speed into RAMP_TABLE_SIZE - 1 equal parts, followed
+// by the maximum speed as the last level. Each level is left after the (rounded) distance covered by
+// the end of its part, and runs at the speed that covers that distance in exactly the time of the part.
+// That keeps the duration of a move the same as for the ideal curve, which moveDuration() relies on.
+/////////////////////////////////
+void InterruptStepper::calculateRamp() {
+  uint32_t rates[RAMP_TABLE_SIZE];
+  uint16_t steps[RAMP_TABLE_SIZE];
+  const byte parts = RAMP_TABLE_SIZE - 1;
+  uint32_t maxRate = max((uint32_t)1, (uint32_t)(_maxSpeed * stepsPerSecondToRate));
+
+#ifdef SLEW_S_CURVE
+  // Speed follows 3u^2 - 2u^3, whose steepest slope is 1.5, so it takes 1.5 times as long.
+  float rampTime = 1.5f * _maxSpeed / max(_acceleration, 1.0f);
+#else
+  float rampTime = _maxSpeed / max(_acceleration, 1.0f);
+#endif
+
+  long lastSteps = 0;
+  for (byte i = 0; i < parts; i++) {
+    float u = (i + 1.0f) / parts;
+#ifdef SLEW_S_CURVE
+    float distance = _maxSpeed * rampTime * u * u * u * (1.0f - 0.5f * u);
+#else
+    float distance = 0.5f * _maxSpeed * rampTime * u * u;
+#endif
+
+    // Every level needs to be at least a step further, so that we never need to skip a level.
+    long nextSteps = min(max((long)(distance + 0.5f), lastSteps + 1), 65535L);
+    float speed = (nextSteps - lastSteps) * parts / rampTime;
+    rates[i] = max((uint32_t)1, min(maxRate, (uint32_t)(speed * stepsPerSecondToRate)));
+    steps[i] = nextSteps;
+    lastSteps = nextSteps;
+  }
+  rates[parts] = maxRate;
+  steps[parts] = lastSteps;
+
+  noInterrupts();
+  for (byte i = 0; i < RAMP_TABLE_SIZE; i++) {
+    _rampRates[i] = rates[i];
+    _rampSteps[i] = steps[i];
+  }
+  if ((_mode == MODE_POSITION) && (_rate != 0)) {
+    _rate = _rampRates[_rampLevel];
+  }
+  interrupts();
+
+  _rampChanged = false;
+}
+
+/////////////////////////////////
+//
+// setSpeed
+//
+/////////////////////////////////
+void InterruptStepper::setSpeed(float stepsPerSecond) {
+  uint32_t rate = (uint32_t)(min(fabs(stepsPerSecond), STEP_TIMER_FREQUENCY - 1.0f) * stepsPerSecondToRate);
+  setStepRate(rate, stepsPerSecond < 0 ? -1 : 1);
+}
+
+/////////////////////////////////
+//
+// setStepRate
+//
+/////////////////////////////////
+void InterruptStepper::setStepRate(uint32_t rate, int8_t direction) {
+  noInterrupts();
+  if ((_mode != MODE_POSITION) && (direction != _direction)) {
+    // The accumulator holds the part of a step already made in the old direction. Going the other
+    // way, that part has to be undone first.
+    _accumulator = -_accumulator;
+  }
+  _direction = direction;
+  _rate = rate;
+  _mode = rate == 0 ? MODE_IDLE : MODE_SPEED;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// speed
+//
+/////////////////////////////////
+float InterruptStepper::speed() const {
+  noInterrupts();
+  float stepsPerSecond = _direction * (_rate / stepsPerSecondToRate);
+  interrupts();
+  return stepsPerSecond;
+}
+
+/////////////////////////////////
+//
+// setTrackingRate
+//
+/////////////////////////////////
+void InterruptStepper::setTrackingRate(uint32_t rate, int8_t direction) {
+  noInterrupts();
+  _trackingBaseRate = rate;
+  _trackingRate = rate;
+  _trackingDirection = direction;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// setTrackingCorrection
+//
+/////////////////////////////////
+void InterruptStepper::setTrackingCorrection(const int8_t* table, byte microstepBits) {
+  noInterrupts();
+  _trackingCorrection = table;
+  _correctionShift = CORRECTION_STEP_BITS + microstepBits;
+  if (table == NULL) {
+    _trackingRate = _trackingBaseRate;
+  }
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// trackingPosition
+//
+/////////////////////////////////
+long InterruptStepper::trackingPosition() const {
+  noInterrupts();
+  long position = _trackingPosition;
+  interrupts();
+  return position;
+}
+
+/////////////////////////////////
+//
+// setTrackingPosition
+//
+/////////////////////////////////
+void InterruptStepper::setTrackingPosition(long position) {
+  noInterrupts();
+  _trackingPosition = position;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// addTrackingToPosition
+//
+/////////////////////////////////
+void InterruptStepper::addTrackingToPosition() {
+  noInterrupts();
+  _position += _trackingPosition;
+  _target += _trackingPosition;
+  _trackingPosition = 0;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// setLimits
+//
+/////////////////////////////////
+void InterruptStepper::setLimits(long low, long high) {
+  noInterrupts();
+  _limitLow = low;
+  _limitHigh = high;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// atLimit
+//
+/////////////////////////////////
+int8_t InterruptStepper::atLimit() const {
+  noInterrupts();
+  int8_t limit = (roomToLimit(1) <= 0) ? 1 : (roomToLimit(-1) <= 0) ? -1 : 0;
+  interrupts();
+  return limit;
+}
+
+/////////////////////////////////
+//
+// clampToLimits
+//
+/////////////////////////////////
+long InterruptStepper::clampToLimits(long position) const {
+  noInterrupts();
+  long tracked = _trackingPosition;
+  interrupts();
+  return constrain(position, _limitLow - tracked, _limitHigh - tracked);
+}
+
+/////////////////////////////////
+//
+// roomToLimit
+//
+// How many steps the axis can still move in the given direction. Moving and tracking both count.
+/////////////////////////////////
+long InterruptStepper::roomToLimit(int8_t direction) const {
+  long axis = _position + _trackingPosition;
+  return (direction > 0) ? _limitHigh - axis : axis - _limitLow;
+}
+
+/////////////////////////////////
+//
+// motorPosition
+//
+/////////////////////////////////
+long InterruptStepper::motorPosition() const {
+  noInterrupts();
+  long position = _motorPosition;
+  interrupts();
+  return position;
+}
+
+/////////////////////////////////
+//
+// setBacklash
+//
+/////////////////////////////////
+void InterruptStepper::setBacklash(int steps) {
+  noInterrupts();
+  _backlash = max(steps, 0);
+
+  // Assume the slack is already taken up in the direction we last moved.
+  _backlashOffset = (_motorDirection > 0) ? _backlash : 0;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// backlash
+//
+/////////////////////////////////
+int InterruptStepper::backlash() const {
+  return _backlash;
+}
+
+/////////////////////////////////
+//
+// moveDuration
+//
+/////////////////////////////////
+float InterruptStepper::moveDuration(long steps) const {
+  float distance = fabs(steps);
+  if ((distance == 0) || (_maxSpeed == 0)) {
+    return 0;
+  }
+
+  float acceleration = max(_acceleration, 1.0f);
+#ifdef SLEW_S_CURVE
+  // The S-curve ramp takes 1.5 times as long as a constant acceleration ramp.
+  acceleration /= 1.5f;
+#endif
+
+  // If we can't reach maximum speed, we accelerate for half the distance and then decelerate.
+  if (distance * acceleration < _maxSpeed * _maxSpeed) {
+    return 2.0f * sqrt(distance / acceleration);
+  }
+  return distance / _maxSpeed + _maxSpeed / acceleration;
+}
+
+/////////////////////////////////
+//
+// moveTo
+//
+/////////////////////////////////
+void InterruptStepper::moveTo(long absolute) {
+  if (_rampChanged) {
+    calculateRamp();
+  }
+
+  noInterrupts();
+  if (_mode == MODE_SPEED) {
+    // Constant speed motion is not ramped, so start the ramp from standstill
+    _rate = 0;
+  }
+  _target = absolute;
+  _mode = MODE_POSITION;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// move
+//
+/////////////////////////////////
+void InterruptStepper::move(long relative) {
+  moveTo(currentPosition() + relative);
+}
+
+/////////////////////////////////
+//
+// stop
+//
+/////////////////////////////////
+void InterruptStepper::stop() {
+  noInterrupts();
+  if (_mode == MODE_POSITION) {
+    // Set the target to the closest point we can stop at
+    _target = _position + _direction * stepsToStop();
+  }
+  else {
+    _rate = 0;
+    _mode = MODE_IDLE;
+  }
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// runToPosition
+//
+/////////////////////////////////
+void InterruptStepper::runToPosition() {
+  while (isRunning()) {
+  }
+}
+
+/////////////////////////////////
+//
+// currentPosition
+//
+/////////////////////////////////
+long InterruptStepper::currentPosition() const {
+  noInterrupts();
+  long position = _position;
+  interrupts();
+  return position;
+}
+
+/////////////////////////////////
+//
+// targetPosition
+//
+/////////////////////////////////
+long InterruptStepper::targetPosition() const {
+  noInterrupts();
+  long target = _target;
+  interrupts();
+  return target;
+}
+
+/////////////////////////////////
+//
+// distanceToGo
+//
+/////////////////////////////////
+long InterruptStepper::distanceToGo() const {
+  noInterrupts();
+  long distance = _target - _position;
+  interrupts();
+  return distance;
+}
+
+/////////////////////////////////
+//
+// setCurrentPosition
+//
+/////////////////////////////////
+void InterruptStepper::setCurrentPosition(long position) {
+  noInterrupts();
+  _position = position;
+  _target = position;
+  _rate = 0;
+  _mode = MODE_IDLE;
+  interrupts();
+}
+
+/////////////////////////////////
+//
+// isRunning
+//
+/////////////////////////////////
+bool InterruptStepper::isRunning() const {
+  return _mode != MODE_IDLE;
+}
+
+/////////////////////////////////
+//
+// tick
+//
+// Called at STEP_TIMER_FREQUENCY by the timer interrupt. Adds up the steps of the tracking and the
+// other motion and returns the step (if any) that the motor takes in this tick.
+/////////////////////////////////
+int8_t InterruptStepper::tick() {
+  int8_t steps = 0;
+  bool tracked = false;
+
+  if (_trackingRate != 0) {
+    uint32_t previous = _trackingAccumulator;
+    _trackingAccumulator += _trackingRate;
+    if (_trackingAccumulator < previous) {
+      if (roomToLimit(_trackingDirection) > 0) {
+        _trackingPosition += _trackingDirection;
+        steps += _trackingDirection;
+        tracked = true;
+      }
+      else {
+        // Tracked into a limit, so stop tracking.
+        _trackingRate = 0;
+      }
+    }
+  }
+
+  if (_mode != MODE_IDLE) {
+    steps += moveTick();
+  }
+
+  // Tracking and moving can cancel each other out, or both step in the same tick. The driver
+  // takes at most one step per tick, so a second step is left for the next tick.
+  // When the two run in opposite directions (like tracking during an east guide pulse), a step against
+  // their net motion waits to cancel out against the next step of the faster one. That way the motor
+  // only reverses (and takes up the backlash) when the net motion does, not on every other step.
+  _pendingSteps += steps;
+  int8_t motorStep = 0;
+  if (_pendingSteps != 0) {
+    int8_t direction = _pendingSteps > 0 ? 1 : -1;
+    int8_t net = netDirection();
+    if ((direction == net) || ((net == 0) && (_trackingRate == 0) && (_mode == MODE_IDLE))) {
+      motorStep = direction;
+      _pendingSteps -= motorStep;
+      _motorDirection = motorStep;
+    }
+  }
+
+  if (motorStep == 0) {
+    // Take up any slack left after reversing, in between the other steps.
+    int slackTarget = (_motorDirection > 0) ? _backlash : 0;
+    if (_backlashOffset != slackTarget) {
+      uint32_t previous = _backlashAccumulator;
+      _backlashAccumulator += backlashRate;
+      if (_backlashAccumulator < previous) {
+        motorStep = (_backlashOffset < slackTarget) ? 1 : -1;
+        _backlashOffset += motorStep;
+      }
+    }
+  }
+
+  _motorPosition += motorStep;
+
+  // Look up the corrected tracking rate for where the motor is now. One unit in the table spreads an
+  // eighth of a (full) step over the steps of the entry, so it changes the rate by 2^-(CORRECTION_STEP_BITS + 3).
+  if (tracked && (_trackingCorrection != NULL) && (_trackingBaseRate != 0)) {
+    int8_t correction = _trackingCorrection[(_motorPosition >> _correctionShift) & (CORRECTION_TABLE_SIZE - 1)];
+    _trackingRate = _trackingBaseRate + correction * (int32_t)(_trackingBaseRate >> (CORRECTION_STEP_BITS + 3));
+  }
+
+  return motorStep;
+}
+
+/////////////////////////////////
+//
+// netDirection
+//
+// The direction the motor moves in when tracking and the other motion are added up: 1 or -1, or 0
+// if nothing moves or both run equally fast in opposite directions.
+/////////////////////////////////
+int8_t InterruptStepper::netDirection() const {
+  uint32_t moveRate = (_mode != MODE_IDLE) ? _rate : 0;
+  if (_trackingRate == 0) {
+    return (moveRate == 0) ? 0 : _direction;
+  }
+  if ((moveRate == 0) || (_direction == _trackingDirection) || (moveRate < _trackingRate)) {
+    return _trackingDirection;
+  }
+  return (moveRate > _trackingRate) ? _direction : 0;
+}
+
+/////////////////////////////////
+//
+// stepsToStop
+//
+// How many steps it takes to come to a stop at the current ramp level. Only valid while moving to a target.
+/////////////////////////////////
+long InterruptStepper::stepsToStop() const {
+  if (_rate == 0) {
+    return 0;
+  }
+  return (_rampLevel == 0) ? 1 : _rampSteps[_rampLevel - 1];
+}
+
+/////////////////////////////////
+//
+// moveTick
+//
+// Runs the non-tracking motion for one tick and returns the step taken (-1, 0 or 1). When moving to a
+// target, the speed only changes when a step is taken, by moving one level up or down the ramp table.
+/////////////////////////////////
+int8_t InterruptStepper::moveTick() {
+  if ((_mode == MODE_POSITION) && (_rate == 0)) {
+    // Start a move (or turn around) from standstill at the lowest level of the ramp.
+    long toGo = _target - _position;
+    if (toGo == 0) {
+      _mode = MODE_IDLE;
+      return 0;
+    }
+    _direction = toGo > 0 ? 1 : -1;
+    _rampLevel = 0;
+    _rampTravel = 0;
+    _rate = _rampRates[0];
+  }
+
+  uint32_t previous = _accumulator;
+  _accumulator += _rate;
+  if (_accumulator >= previous) {
+    return 0;
+  }
+
+  // The accumulator overflowed, so it's time for a step. Unless the axis is at a limit, then stop.
+  // Constant speed motion stops dead, moves to a target have slowed down for the limit already.
+  long room = roomToLimit(_direction);
+  if (room <= 0) {
+    _rate = 0;
+    _target = _position;
+    _mode = MODE_IDLE;
+    return 0;
+  }
+
+  _position += _direction;
+
+  if (_mode == MODE_POSITION) {
+    // Distance ahead of us in the direction we are moving. Negative if the target is behind us.
+    // A limit that comes before the target is treated as the target, so we decelerate into it.
+    long ahead = (_target - _position) * _direction;
+    if (room - 1 < ahead) {
+      ahead = room - 1;
+    }
+    _rampTravel++;
+
+    if (ahead == 0) {
+      _rate = 0;
+      _target = _position;
+      _mode = MODE_IDLE;
+    }
+    else if ((ahead < 0) && (_rampLevel == 0)) {
+      // Stop here and turn around on the next tick.
+      _rate = 0;
+    }
+    else if ((_rampLevel > 0) && (ahead <= _rampSteps[_rampLevel - 1])) {
+      _rate = _rampRates[--_rampLevel];
+    }
+    else if ((_rampLevel < RAMP_TABLE_SIZE - 1) && (_rampTravel >= _rampSteps[_rampLevel]) && (ahead > _rampSteps[_rampLevel])) {
+      _rate = _rampRates[++_rampLevel];
+    }
+  }
+
+  return _direction;
+}
+
+#ifdef DEBUG_MODE
+/////////////////////////////////
+//
+// recordTickDuration
+//
+/////////////////////////////////
+void InterruptStepper::recordTickDuration(unsigned long duration) {
+  if (duration > _maxTickDuration) {
+    _maxTickDuration = duration;
+  }
+}
+#endif
+
+#ifdef DEBUG_MODE
+/////////////////////////////////
+//
+// maxTickDuration
+//
+/////////////////////////////////
+unsigned long InterruptStepper::maxTickDuration() {
+  noInterrupts();
+  unsigned long duration = _maxTickDuration;
+  interrupts();
+  return duration;
+}
+#endif
@@ -0,0 +1,224 @@
+#ifndef _INTERRUPTSTEPPER_HPP_
+#define _INTERRUPTSTEPPER_HPP_
+
+#include <Arduino.h>
+#include "Globals.h"
+
+// How often (in Hz) the hardware timer interrupt services all steppers. No stepper
+// can run faster than this. The interval (200us) is also the worst case step jitter.
+// Step/dir drivers that microstep may need more, this can be set in Globals.h.
+#ifndef STEP_TIMER_FREQUENCY
+#define STEP_TIMER_FREQUENCY 5000
+#endif
+
+// How many speed levels the acceleration ramp of a move is made of.
+#define RAMP_TABLE_SIZE 16
+
+// How fast (in steps/s) the slack in the gears is taken up when the motor reverses.
+#define BACKLASH_SPEED 1000
+
+// The tracking rate can be corrected with a table indexed by the motor position. Each of the
+// CORRECTION_TABLE_SIZE entries covers 2^CORRECTION_STEP_BITS motor (full) steps, so the table repeats
+// every 4096 halfsteps, which is one turn of the 28BYJ-48 output shaft.
+#define CORRECTION_TABLE_SIZE 64
+#define CORRECTION_STEP_BITS 6
+
+// The limits used when none are set. Far enough out to never be reached, close enough to not overflow.
+#define NO_LIMIT 0x3FFFFFFFL
+
+//////////////////////////////////////////////////////////////////
+//
+// Class that runs a stepper from a hardware timer interrupt, independent of how long the main
+// loop takes, so slow LCD updates or serial commands no longer delay any steps. This class
+// works out when to step. Driving the motor is left to the StepperAxis template (see
+// StepperDrivers.hpp), which knows the driver board and its pins at compile time.
+//
+// The interface mirrors the parts of AccelStepper that the mount uses. The main code only
+// sets speeds and targets; it never needs to call run() to make the motor move.
+//
+// All speeds are kept as unsigned 0.32 fixed point 'steps per timer tick' values. Each tick
+// the speed is added to an accumulator and a step is taken whenever the accumulator overflows.
+//
+// Moves to a target are ramped with a table of RAMP_TABLE_SIZE speed levels and the number of
+// steps after which each level is reached. The table is calculated once when a move starts after
+// the maximum speed or acceleration has changed. The interrupt only looks up the next level
+// when a step is taken, which is a compare or two. Decelerating plays the table backwards, so the
+// distance needed to stop is always a table entry. Define SLEW_S_CURVE to ramp with a smooth
+// (jerk limited) curve instead of constant acceleration.
+//
+// A stepper can also track at a constant rate. Tracking is added on top of any other motion,
+// so the motor moves at the sum of both, but its steps are counted separately. That way
+// currentPosition() and the targets are in mount coordinates (which stay fixed on the sky)
+// and motorPosition() is the one position that the coils are actually driven from. The motor
+// takes at most one step per tick, so when both step in the same tick, one step waits for the next.
+//
+// When the motor reverses, it first needs to take up the slack (backlash) in the gears before the
+// axis moves. The stepper adds these extra steps at BACKLASH_SPEED when the motor reverses. They are
+// only part of motorPosition(), so the mount coordinate and tracked steps are not affected. Only the
+// net motion of tracking and the other motion reverses the motor, their steps cancel out otherwise.
+//
+// The tracking rate can be modulated with a correction table, to cancel out the periodic error
+// of the gears. After every tracking step the rate is looked up for the current motor position.
+//
+// The axis can be kept between two limits. These apply to where the axis is (the current position plus the
+// tracked steps), and are checked before every step, whatever causes it. Moves to a target decelerate to a
+// stop at a limit that comes before the target. Constant speed motion and tracking simply stop there.
+//
+//////////////////////////////////////////////////////////////////
+class InterruptStepper {
+public:
+  InterruptStepper();
+
+  // Start the timer interrupt that services the steppers. Call from setup(), since the Arduino core
+  // sets up the timers for PWM before that.
+  static void startTimer();
+
+  // Set the maximum speed (steps/s) used when moving to a target.
+  void setMaxSpeed(float stepsPerSecond);
+
+  // Set the acceleration and deceleration (steps/s/s) used when moving to a target. For S-curve ramps
+  // this is the peak acceleration.
+  void setAcceleration(float stepsPerSecondPerSecond);
+
+  // Run continuously at the given speed (steps/s, negative runs backwards) until stop() is called.
+  // This is not ramped and not limited by the maximum speed.
+  void setSpeed(float stepsPerSecond);
+
+  // Run continuously at the given fixed point rate (0.32 steps per tick) in the given direction (1 or -1).
+  // One bit of rate is 2^-32 steps per 200us tick, which is finer than 2^-39 steps/us.
+  // The fraction of a step that is left when the motor stops is kept, so a run of short moves at
+  // constant speed (like guide pulses) adds up to the same steps as one long move.
+  void setStepRate(uint32_t rate, int8_t direction);
+
+  // Get the current signed speed in steps/s (not including tracking)
+  float speed() const;
+
+  // Track at the given fixed point rate (0.32 steps per tick) in the given direction (1 or -1), on top of
+  // any other motion. A rate of 0 stops tracking.
+  void setTrackingRate(uint32_t rate, int8_t direction);
+
+  // Correct the tracking rate with the given table of CORRECTION_TABLE_SIZE entries, or stop correcting if NULL.
+  // Each entry is the number of eighths of a step to add to the tracking steps while the motor moves through
+  // that entry's 2^CORRECTION_STEP_BITS steps. For a driver that microsteps, give the number of bits of the
+  // motor position that are microsteps, then the entries cover (and correct by eighths of) full steps.
+  // The table is not copied, so it must stay valid while in use.
+  void setTrackingCorrection(const int8_t* table, byte microstepBits = 0);
+
+  // Get the number of steps the motor has moved because of tracking.
+  long trackingPosition() const;
+
+  // Redefine the number of tracking steps.
+  void setTrackingPosition(long position);
+
+  // Move the tracked steps into the current position (and the target), so that they become part of the mount
+  // coordinate. Tracking carries on from 0. This does not stop any motion.
+  void addTrackingToPosition();
+
+  // Set how many steps of slack there are in the gears. These are taken up each time the motor reverses.
+  void setBacklash(int steps);
+  int backlash() const;
+
+  // Keep the axis (the current position plus the tracked steps) between low and high.
+  void setLimits(long low, long high);
+
+  // Returns 1 if the axis is at its high limit, -1 if at its low limit, otherwise 0.
+  int8_t atLimit() const;
+
+  // Clamp the given target position, so that the axis would stay within the limits.
+  long clampToLimits(long position) const;
+
+  // Get the position of the motor. This counts every step the motor has taken (moving, tracking and taking
+  // up backlash) since it was created, and is not changed by setCurrentPosition().
+  long motorPosition() const;
+
+  // Get how long (in seconds) it takes to move the given number of steps from standstill, at the
+  // current maximum speed and acceleration.
+  float moveDuration(long steps) const;
+
+  // Move to the given absolute position, accelerating and decelerating as needed. Recalculates the
+  // ramp table if the maximum speed or acceleration have changed.
+  void moveTo(long absolute);
+
+  // Move the given number of steps relative to the current position.
+  void move(long relative);
+
+  // Decelerate to a stop as quickly as possible. Constant speed motion stops immediately.
+  void stop();
+
+  // Block until the target position has been reached.
+  void runToPosition();
+
+  long currentPosition() const;
+  long targetPosition() const;
+  long distanceToGo() const;
+
+  // Redefine the current position (and the target) to be the given position. Stops any motion.
+  void setCurrentPosition(long position);
+
+  // Returns true if the motor is moving or has not yet reached its target. Tracking is not considered.
+  bool isRunning() const;
+
+  // Advance the motor by one timer tick and return the step that the motor needs to take (-1, 0 or 1).
+  // Called from the timer interrupt only.
+  int8_t tick();
+
+#ifdef DEBUG_MODE
+  // The longest time (in us) that the timer interrupt took to service all steppers.
+  static unsigned long maxTickDuration();
+  static void recordTickDuration(unsigned long duration);
+#endif
+
+private:
+  int8_t moveTick();
+  int8_t netDirection() const;
+  void calculateRamp();
+  long stepsToStop() const;
+  long roomToLimit(int8_t direction) const;
+
+protected:
+  volatile long _motorPosition;
+
+private:
+  volatile byte _mode;
+  volatile int8_t _direction;
+  volatile long _position;
+  volatile long _target;
+  volatile uint32_t _rate;
+  uint32_t _accumulator;
+
+  // The ramp table. Level i runs at _rampRates[i] and is reached after _rampSteps[i - 1] steps. Because
+  // deceleration mirrors acceleration, _rampSteps[i - 1] is also how many steps it takes to stop from level i.
+  float _maxSpeed;
+  float _acceleration;
+  bool _rampChanged;
+  uint32_t _rampRates[RAMP_TABLE_SIZE];
+  uint16_t _rampSteps[RAMP_TABLE_SIZE];
+  volatile byte _rampLevel;
+  volatile long _rampTravel;
+
+  volatile long _trackingPosition;
+  volatile uint32_t _trackingRate;
+  volatile uint32_t _trackingBaseRate;
+  volatile int8_t _trackingDirection;
+  uint32_t _trackingAccumulator;
+  const int8_t* volatile _trackingCorrection;
+  volatile byte _correctionShift;
+
+  // _backlashOffset runs from 0 (slack taken up for moving backwards) to _backlash (for moving forwards).
+  volatile int _backlash;
+  volatile int _backlashOffset;
+  int8_t _motorDirection;
+  uint32_t _backlashAccumulator;
+
+  // Steps of tracking and motion that the motor still has to take, at most one per tick.
+  int _pendingSteps;
+
+  volatile long _limitLow;
+  volatile long _limitHigh;
+
+#ifdef DEBUG_MODE
+  static volatile unsigned long _maxTickDuration;
+#endif
+};
+
+#endif
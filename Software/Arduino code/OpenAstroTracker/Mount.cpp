@@ -1,9 +1,23 @@
+#include "Utility.h"
 #include "LcdMenu.hpp"
 
 #include "Mount.hpp"
+#include "MountGeometry.hpp"
+
+#ifdef SUPPORT_PEC
+#include <EEPROM.h>
+
+// How many turns of the RA motor the PEC recording is averaged over.
+#define PEC_RECORD_CYCLES          3
+
+// Where the PEC table is stored in EEPROM. The first byte marks that a table has been stored.
+#define PEC_EEPROM_ADDRESS         8
+#define PEC_EEPROM_MARKER          0xA5
+#endif
 
 //mountstatus
 #define STATUS_PARKED              B00000000
+#define STATUS_STOPPING            B00000001
 #define STATUS_SLEWING             B00000010
 #define STATUS_SLEWING_TO_TARGET   B00000100
 #define STATUS_SLEWING_FREE        B00000010
@@ -15,6 +29,19 @@
 #define STATUS_GUIDE_PULSE_DEC     B00100000
 #define STATUS_GUIDE_PULSE_MASK    B11100000
 
+// Background jobs. Parking (above) and finding home wait for STATUS_STOPPING to clear before
+// they start slewing.
+#define STATUS_FINDING_HOME        0x0100
+#define STATUS_HOME_TRACKING       0x0200
+#define STATUS_JOB_MASK            (STATUS_PARKING | STATUS_FINDING_HOME)
+
+// Drift alignment runs in the background too, and turns tracking back on when done if STATUS_DRIFT_TRACKING is set.
+#define STATUS_DRIFT_ALIGNING      0x0400
+#define STATUS_DRIFT_TRACKING      0x0800
+
+// How long (in ms) drift alignment pauses before, between and after the passes.
+#define DRIFT_PAUSE_TIME           1500
+
 // slewingStatus()
 #define SLEWING_DEC                B00000010
 #define SLEWING_RA                 B00000001
@@ -38,6 +65,7 @@ char* formatStringsDEC[] = {
   "%c%02d %02d'%02d\"",     // Print
   "%c%02d@%02d'%02d\"",     // LCD display only
   "%c%02d%02d%02d",         // Compact
+  "%c%02d*%02d'%02d.%d#",   // Meade, with tenths of seconds
 };
 
 char* formatStringsRA[] = {
@@ -47,23 +75,69 @@ char* formatStringsRA[] = {
   "%02dh %02dm %02ds",      // Print
   "%02dh%02dm%02ds",        // LCD display only
   "%02d%02d%02d",           // Compact
+  "%02d:%02d:%02d.%d#",     // Meade, with tenths of seconds
 };
 
-const float siderealDegreesInHour = 14.95902778;
+// How far one step turns each axis, in DayTime units (hundredths of a second of time or arc).
+const float timeUnitsPerRAStep = TIME_UNITS_PER_HOUR / stepsPerSiderealHour;
+const float timeUnitsPerDECStep = TIME_UNITS_PER_HOUR / (float)stepsPerDECDegree;
+
+// The lunar and solar tracking rates, as a fraction of the sidereal rate scaled by 10^6. Indexed by TRACKING_SIDEREAL,
+// TRACKING_LUNAR and TRACKING_SOLAR. The stars move 15.041"/s, the Moon 14.685"/s and the Sun 15.0"/s.
+const uint32_t trackingRatesE6[] = { 1000000UL, 976327UL, 997270UL };
 /////////////////////////////////
 //
 // CTOR
 //
 /////////////////////////////////
-Mount::Mount(int stepsPerRADegree, int stepsPerDECDegree, LcdMenu* lcdMenu) {
-  _stepsPerRADegree = stepsPerRADegree;
-  _stepsPerDECDegree = stepsPerDECDegree;
+Mount::Mount(LcdMenu* lcdMenu) {
   _lcdMenu = lcdMenu;
   _mountStatus = 0;
   _lastDisplayUpdate = 0;
   _stepperWasRunning = false;
   _totalDECMove = 0;
   _totalRAMove = 0;
+  _slewStartTime = 0;
+  _slewDuration = 0;
+  _driftPhase = DRIFT_PAUSE_START;
+  _isUnreachable = false;
+  _trackingRateMode = TRACKING_SIDEREAL;
+  _customTrackingRateE6 = 1000000UL;
+#ifdef SUPPORT_KING_RATE
+  _latitude = 45.0f;
+  _kingRateE6 = 1000000UL;
+  _kingRateDEC = 0;
+  _kingDirectionDEC = 1;
+  _lastKingUpdate = 0;
+#endif
+  _siderealClockMicros = 0;
+  _lastSiderealUpdate = 0;
+  _baseTrackingSteps = 0;
+  _localYear = 2000;
+  _localMonth = 1;
+  _localDay = 1;
+  _localTimeMillis = 0;
+  _hasLocalDate = false;
+  _hasLocalTime = false;
+  _utcOffset = 0;
+  _longitude = 0;
+  _guideRateRA = MAX_GUIDE_RATE;
+  _guideRateDEC = MAX_GUIDE_RATE;
+#ifdef SUPPORT_ALIGNMENT
+  _alignmentCount = 0;
+  _nextAlignmentStar = 0;
+  _alignmentStars = 0;
+#endif
+  _currentRASteps = 0;
+  _currentDECSteps = 0;
+  _anchorRASteps = 0;
+  _anchorDECSteps = 0;
+  _anchorFlipped = false;
+#ifdef SUPPORT_PEC
+  _pecSums = NULL;
+  _pecStatus = PEC_OFF;
+  _pecValid = false;
+#endif
   setSpeedCalibration(1.0);
 }
 
@@ -72,18 +146,11 @@ Mount::Mount(int stepsPerRADegree, int stepsPerDECDegree, LcdMenu* lcdMenu) {
 // configureRAStepper
 //
 /////////////////////////////////
-void Mount::configureRAStepper(byte stepMode, byte pin1, byte pin2, byte pin3, byte pin4, int maxSpeed, int maxAcceleration)
+void Mount::configureRAStepper(InterruptStepper* stepper)
 {
-  _stepperRA = new AccelStepper(stepMode, pin1, pin2, pin3, pin4);
-  _stepperRA->setMaxSpeed(maxSpeed);
-  _stepperRA->setAcceleration(maxAcceleration);
-  _maxRASpeed = maxSpeed;
-  _maxRAAcceleration = maxAcceleration;
-
-  // Use another AccelStepper to run the RA motor as well. This instance tracks earths rotation.
-  _stepperTRK = new AccelStepper(HALFSTEP, pin1, pin2, pin3, pin4);
-  _stepperTRK->setMaxSpeed(10);
-  _stepperTRK->setAcceleration(2500);
+  _stepperRA = stepper;
+  _stepperRA->setMaxSpeed(raMaxSpeed);
+  _stepperRA->setAcceleration(raAcceleration);
 }
 
 /////////////////////////////////
@@ -91,13 +158,106 @@ void Mount::configureRAStepper(byte stepMode, byte pin1, byte pin2, byte pin3, b
 // configureDECStepper
 //
 /////////////////////////////////
-void Mount::configureDECStepper(byte stepMode, byte pin1, byte pin2, byte pin3, byte pin4, int maxSpeed, int maxAcceleration)
+void Mount::configureDECStepper(InterruptStepper* stepper)
 {
-  _stepperDEC = new AccelStepper(stepMode, pin4, pin3, pin2, pin1);
-  _stepperDEC->setMaxSpeed(maxSpeed);
-  _stepperDEC->setAcceleration(maxAcceleration);
-  _maxDECSpeed = maxSpeed;
-  _maxDECAcceleration = maxAcceleration;
+  _stepperDEC = stepper;
+  _stepperDEC->setMaxSpeed(decMaxSpeed);
+  _stepperDEC->setAcceleration(decAcceleration);
+}
+
+/////////////////////////////////
+//
+// setBacklash
+//
+/////////////////////////////////
+void Mount::setBacklash(int direction, int steps) {
+  if (direction & (NORTH | SOUTH)) {
+    _stepperDEC->setBacklash(steps * decStepFactor);
+  }
+  if (direction & (EAST | WEST)) {
+    _stepperRA->setBacklash(steps * raStepFactor);
+  }
+}
+
+/////////////////////////////////
+//
+// setLimits
+//
+/////////////////////////////////
+void Mount::setLimits(int direction, long low, long high) {
+  if (direction & (NORTH | SOUTH)) {
+    _stepperDEC->setLimits(low * decStepFactor, high * decStepFactor);
+  }
+  if (direction & (EAST | WEST)) {
+    _stepperRA->setLimits(low * raStepFactor, high * raStepFactor);
+  }
+}
+
+/////////////////////////////////
+//
+// atLimit
+//
+/////////////////////////////////
+int Mount::atLimit() const {
+  int limits = 0;
+  if (_stepperRA->atLimit() != 0) {
+    limits |= (_stepperRA->atLimit() > 0) ? WEST : EAST;
+  }
+  if (_stepperDEC->atLimit() != 0) {
+    limits |= (_stepperDEC->atLimit() > 0) ? NORTH : SOUTH;
+  }
+  return limits;
+}
+
+/////////////////////////////////
+//
+// isUnreachable
+//
+/////////////////////////////////
+bool Mount::isUnreachable() const {
+  return _isUnreachable;
+}
+
+/////////////////////////////////
+//
+// setGuideRate
+//
+/////////////////////////////////
+void Mount::setGuideRate(int direction, byte tenths) {
+  tenths = constrain(tenths, MIN_GUIDE_RATE, MAX_GUIDE_RATE);
+  if (direction & (NORTH | SOUTH)) {
+    _guideRateDEC = tenths;
+  }
+  if (direction & (EAST | WEST)) {
+    _guideRateRA = tenths;
+  }
+}
+
+/////////////////////////////////
+//
+// getGuideRate
+//
+/////////////////////////////////
+byte Mount::getGuideRate(int direction) {
+  if (direction & (NORTH | SOUTH)) {
+    return _guideRateDEC;
+  }
+  return _guideRateRA;
+}
+
+/////////////////////////////////
+//
+// getBacklash
+//
+/////////////////////////////////
+int Mount::getBacklash(int direction) {
+  if (direction & (NORTH | SOUTH)) {
+    return _stepperDEC->backlash() / decStepFactor;
+  }
+  if (direction & (EAST | WEST)) {
+    return _stepperRA->backlash() / raStepFactor;
+  }
+  return 0;
 }
 
 float Mount::getSpeedCalibration() {
@@ -107,10 +267,185 @@ float Mount::getSpeedCalibration() {
 void Mount::setSpeedCalibration(float val) {
   _trackingSpeedCalibration = val;
 
+  // The step timer runs the tracking motor at a fixed point rate of steps per tick with 32 fractional bits.
+  // Calculate that with integer math so it isn't rounded to the 24 bit mantissa of a float. The calibration
+  // factor is set in steps of 0.0001, so it is scaled by 10^4.
+  uint32_t calibrationE4 = (uint32_t)(_trackingSpeedCalibration * 10000.0f + 0.5f);
+  uint64_t stepsPerHourE11 = (uint64_t)stepsPerRADegree * siderealDegreesInHourE7 * calibrationE4;
+  _siderealRate = fixedPointFraction(stepsPerHourE11, 3600ULL * STEP_TIMER_FREQUENCY * 100000000000ULL);
+
+  updateTrackingRate();
+}
+
+/////////////////////////////////
+//
+// calibratedStepsPerSiderealHour
+//
+// Tracking steps come at the calibrated rate, so that is how they convert back to sidereal time.
+/////////////////////////////////
+float Mount::calibratedStepsPerSiderealHour() const {
+  return stepsPerSiderealHour * _trackingSpeedCalibration;
+}
+
+/////////////////////////////////
+//
+// trackingRateE6
+//
+// The tracking rate for the tracking rate mode, as a fraction of the sidereal rate scaled by 10^6.
+/////////////////////////////////
+uint32_t Mount::trackingRateE6() const {
+  switch (_trackingRateMode) {
+#ifdef SUPPORT_KING_RATE
+    case TRACKING_KING: return _kingRateE6;
+#endif
+    case TRACKING_CUSTOM: return _customTrackingRateE6;
+  }
+  return trackingRatesE6[_trackingRateMode];
+}
+
+/////////////////////////////////
+//
+// updateTrackingRate
+//
+// Works out the tracking rate for the calibration and the tracking rate mode.
+/////////////////////////////////
+void Mount::updateTrackingRate() {
+  uint32_t rateE6 = trackingRateE6();
+
   // The tracker simply needs to rotate at 15degrees/hour, adjusted for sidereal
   // time (i.e. the 15degrees is per 23h56m04s. 86164s/86400 = 0.99726852. 3590/3600 is the same ratio) So we only go 15 x 0.99726852 in an hour.
-  _trackingSpeed = _trackingSpeedCalibration * _stepsPerRADegree * siderealDegreesInHour / 3600.0f;
+  _trackingSpeed = (calibratedStepsPerSiderealHour() / 3600.0f) * rateE6 / 1000000.0f;
+  _trackingRate = (uint64_t)_siderealRate * rateE6 / 1000000UL;
+
+  // Changing the rate is free for the step timer, so apply it right away.
+  if (_mountStatus & STATUS_TRACKING) {
+    _stepperRA->setTrackingRate(_trackingRate, 1);
+#ifdef SUPPORT_KING_RATE
+    _stepperDEC->setTrackingRate((_trackingRateMode == TRACKING_KING) ? _kingRateDEC : 0, _kingDirectionDEC);
+#endif
+  }
+}
+
+#ifdef SUPPORT_KING_RATE
+
+/////////////////////////////////
+//
+// updateKingRate
+//
+// The King rate is how fast the stars move as refraction shows them. It is measured by refracting the
+// position half a KING_RATE_SPAN before and after where the mount points. The trig is far too slow for
+// the step timer, so this only runs every KING_RATE_INTERVAL and hands the timer new fixed point rates.
+/////////////////////////////////
+void Mount::updateKingRate() {
+  // Work out where the axes really point, including the tracked steps. The RA stepper is at 0 when the
+  // mount points at the meridian, and moves with the hour angle.
+  long raPosition = _stepperRA->currentPosition() + _stepperRA->trackingPosition();
+  long decPosition = _stepperDEC->currentPosition() + _stepperDEC->trackingPosition();
+  float hourAngle = -stepperRAHours(raPosition) + ((decPosition < 0) ? 12.0f : 0.0f);
+  float declination = 90.0f + stepperDECDegrees(decPosition);
+  if (!NORTHERN_HEMISPHERE) {
+    declination = -declination;
+  }
+
+  float haBefore = hourAngle - KING_RATE_SPAN / 2;
+  float decBefore = declination;
+  float haAfter = hourAngle + KING_RATE_SPAN / 2;
+  float decAfter = declination;
+  refractHADEC(haBefore, decBefore, _latitude);
+  refractHADEC(haAfter, decAfter, _latitude);
+
+  float haMoved = haAfter - haBefore;
+  if (haMoved < -12.0f) haMoved += 24.0f;
+  if (haMoved > 12.0f) haMoved -= 24.0f;
+  _kingRateE6 = (uint32_t)(haMoved / KING_RATE_SPAN * 1000000.0f + 0.5f);
+
+  // DEC moves by this many degrees for each degree that the hour angle moves, towards the pole if positive.
+  float decRate = (decAfter - decBefore) / (KING_RATE_SPAN * 15.0f);
+  if (!NORTHERN_HEMISPHERE) {
+    decRate = -decRate;
+  }
+
+  // The DEC stepper moves away from the pole in both directions, so towards the pole is back to 0.
+  _kingDirectionDEC = ((decRate > 0) == (decPosition >= 0)) ? -1 : 1;
+  _kingRateDEC = (uint32_t)(fabs(decRate) * _siderealRate * decStepsPerRAStep);
+
+  updateTrackingRate();
+}
+#endif
+
+/////////////////////////////////
+//
+// setTrackingRateMode
+//
+/////////////////////////////////
+void Mount::setTrackingRateMode(byte mode) {
+#ifndef SUPPORT_KING_RATE
+  if (mode == TRACKING_KING) {
+    return;
+  }
+#endif
+  if (mode <= TRACKING_CUSTOM) {
+    _trackingRateMode = mode;
+#ifdef SUPPORT_KING_RATE
+    if (mode == TRACKING_KING) {
+      updateKingRate();
+      _lastKingUpdate = millis();
+      return;
+    }
+#endif
+    updateTrackingRate();
+  }
+}
+
+/////////////////////////////////
+//
+// getTrackingRateMode
+//
+/////////////////////////////////
+byte Mount::getTrackingRateMode() const {
+  return _trackingRateMode;
+}
+
+/////////////////////////////////
+//
+// setCustomTrackingRate
+//
+/////////////////////////////////
+void Mount::setCustomTrackingRate(float siderealFraction) {
+  _customTrackingRateE6 = (uint32_t)(siderealFraction * 1000000.0f + 0.5f);
+  if (_trackingRateMode == TRACKING_CUSTOM) {
+    updateTrackingRate();
+  }
+}
+
+/////////////////////////////////
+//
+// getTrackingRateFactor
+//
+/////////////////////////////////
+float Mount::getTrackingRateFactor() const {
+  return trackingRateE6() / 1000000.0f;
+}
+
+#ifdef SUPPORT_KING_RATE
+/////////////////////////////////
+//
+// setLatitude
+//
+/////////////////////////////////
+void Mount::setLatitude(float degrees) {
+  _latitude = degrees;
+}
+
+/////////////////////////////////
+//
+// getLatitude
+//
+/////////////////////////////////
+float Mount::getLatitude() const {
+  return _latitude;
 }
+#endif
 
 /////////////////////////////////
 //
@@ -118,326 +453,999 @@ void Mount::setSpeedCalibration(float val) {
 //
 /////////////////////////////////
 void Mount::setHA(const DayTime& haTime) {
+  applyHA(haTime);
+  _lastHASet = millis();
+
+  // HA moves along from here, see updateSiderealTime().
+  updateSiderealClock();
+  _baseHA = haTime;
+  _baseSiderealClock = _siderealClock;
+  _baseTrackingSteps = _stepperRA->trackingPosition();
+}
+
+/////////////////////////////////
+//
+// applyHA
+//
+/////////////////////////////////
+void Mount::applyHA(const DayTime& haTime) {
   _HATime = haTime;
   _HACorrection.set(_HATime);
   _HACorrection.subtractTime(_HAAdjust);
-  _lastHASet = millis();
 }
 
 /////////////////////////////////
 //
-// setHACorrection
+// updateSiderealClock
+//
+/////////////////////////////////
+void Mount::updateSiderealClock() {
+  // A hundredth of a sidereal second lasts 9972.696us. Only whole ones are counted, the rest carries over to the next update.
+  unsigned long elapsed = micros() - _siderealClockMicros;
+  long units = (uint64_t)elapsed * 1000 / 9972696UL;
+  _siderealClockMicros += (uint64_t)units * 9972696UL / 1000;
+  _siderealClock.setTotalUnits(_siderealClock.getTotalUnits() + units);
+}
+
+/////////////////////////////////
+//
+// updateSiderealTime
+//
+// The sky turns by the sidereal time that passes. Tracking turns the mount coordinates along with it, so HA
+// only needs to move by whatever tracking did not follow. That is all of it when not tracking, and the
+// difference when tracking at a rate other than sidereal.
+/////////////////////////////////
+void Mount::updateSiderealTime() {
+  updateSiderealClock();
+
+  DayTime passed(_siderealClock);
+  passed.subtractTime(_baseSiderealClock);
+
+  DayTime ha(_baseHA);
+  ha.addTime(passed);
+  ha.subtractTime(DayTime((_stepperRA->trackingPosition() - _baseTrackingSteps) / calibratedStepsPerSiderealHour()));
+  applyHA(ha);
+}
+
+/////////////////////////////////
+//
+// setHAFromLocalTime
+//
+/////////////////////////////////
+void Mount::setHAFromLocalTime() {
+  if (!_hasLocalDate || !_hasLocalTime) {
+    return;
+  }
+
+  // The local time is not wrapped at midnight, since the date has not moved along with it.
+  long localUnits = _localTime.getTotalUnits() + (millis() - _localTimeMillis) / (1000L / TIME_UNITS_PER_SECOND);
+  long utcUnits = localUnits + (long)(_utcOffset * TIME_UNITS_PER_HOUR);
+  DayTime lst;
+  lst.setTotalUnits(greenwichSiderealTime(_localYear, _localMonth, _localDay, utcUnits) + (long)(_longitude * 240 * TIME_UNITS_PER_SECOND));
+
+  // The RA on the meridian is the HA correction plus how far the mount has tracked (see localSiderealTime()).
+  DayTime ha(lst);
+  ha.subtractTime(DayTime(_stepperRA->trackingPosition() / calibratedStepsPerSiderealHour()));
+  ha.addTime(_HAAdjust);
+  setHA(ha);
+}
+
+/////////////////////////////////
+//
+// setLocalDate
+//
+/////////////////////////////////
+void Mount::setLocalDate(int year, int month, int day) {
+  _localYear = year;
+  _localMonth = month;
+  _localDay = day;
+  _hasLocalDate = true;
+  _precession.setDate(year, month, day);
+  setHAFromLocalTime();
+}
+
+/////////////////////////////////
+//
+// getLocalDate
+//
+/////////////////////////////////
+void Mount::getLocalDate(int& year, int& month, int& day) const {
+  year = _localYear;
+  month = _localMonth;
+  day = _localDay;
+}
+
+/////////////////////////////////
+//
+// setLocalTime
+//
+/////////////////////////////////
+void Mount::setLocalTime(const DayTime& localTime) {
+  _localTime = localTime;
+  _localTimeMillis = millis();
+  _hasLocalTime = true;
+  setHAFromLocalTime();
+}
+
+/////////////////////////////////
+//
+// localTime
+//
+/////////////////////////////////
+DayTime Mount::localTime() const {
+  DayTime local;
+  local.setTotalUnits(_localTime.getTotalUnits() + (millis() - _localTimeMillis) / (1000L / TIME_UNITS_PER_SECOND));
+  return local;
+}
+
+/////////////////////////////////
+//
+// setUTCOffset
+//
+/////////////////////////////////
+void Mount::setUTCOffset(float hours) {
+  _utcOffset = hours;
+  setHAFromLocalTime();
+}
+
+/////////////////////////////////
+//
+// getUTCOffset
+//
+/////////////////////////////////
+float Mount::getUTCOffset() const {
+  return _utcOffset;
+}
+
+/////////////////////////////////
+//
+// setLongitude
+//
+/////////////////////////////////
+void Mount::setLongitude(float degrees) {
+  _longitude = degrees;
+  setHAFromLocalTime();
+}
+
+/////////////////////////////////
+//
+// getLongitude
+//
+/////////////////////////////////
+float Mount::getLongitude() const {
+  return _longitude;
+}
+
+/////////////////////////////////
+//
+// localSiderealTime
+//
+/////////////////////////////////
+DayTime Mount::localSiderealTime() const {
+  // The HA correction is the RA that RA stepper position 0 pointed at on the meridian. The mount has tracked
+  // along with the sky since, which moved the meridian on by as much.
+  DayTime lst(_HACorrection);
+  lst.addTime(DayTime(_stepperRA->trackingPosition() / calibratedStepsPerSiderealHour()));
+  return lst;
+}
+
+/////////////////////////////////
+//
+// setHACorrection
+//
+/////////////////////////////////
+void Mount::setHACorrection(int h, int m, int s) {
+  _HAAdjust.set(h, m, s);
+}
+
+/////////////////////////////////
+//
+// getHACorrection
+//
+/////////////////////////////////
+DayTime Mount::getHACorrection() {
+  return _HAAdjust;
+}
+/////////////////////////////////
+//
+// HA
+//
+/////////////////////////////////
+const DayTime& Mount::HA() const {
+  return _HATime;
+}
+
+/////////////////////////////////
+//
+// precessToDate
+//
+/////////////////////////////////
+void Mount::precessToDate(float& raHours, float& decDegrees) const {
+  _precession.toDate(raHours, decDegrees);
+}
+
+/////////////////////////////////
+//
+// setTargetJ2000
+//
+/////////////////////////////////
+void Mount::setTargetJ2000(float raHours, float decDegrees) {
+  _precession.toDate(raHours, decDegrees);
+  _targetRA = DayTime(raHours);
+  _targetRA.subtractTime(_HACorrection);
+
+  // The internal DEC is 0 at the celestial pole
+  _targetDEC = DegreeTime(decDegrees - (NORTHERN_HEMISPHERE ? 90 : -90));
+}
+
+/////////////////////////////////
+//
+// targetRA
+//
+/////////////////////////////////
+// Get a reference to the target RA value.
+DayTime& Mount::targetRA() {
+  return _targetRA;
+}
+
+/////////////////////////////////
+//
+// targetDEC
+//
+/////////////////////////////////
+// Get a reference to the target DEC value.
+DegreeTime& Mount::targetDEC() {
+  return _targetDEC;
+}
+
+/////////////////////////////////
+//
+// currentRA
+//
+/////////////////////////////////
+// Get current RA value.
+const DayTime Mount::currentRA() const {
+  return _currentRA;
+}
+
+/////////////////////////////////
+//
+// currentDEC
+//
+/////////////////////////////////
+// Get current DEC value.
+const DegreeTime Mount::currentDEC() const {
+  return _currentDEC;
+}
+
+/////////////////////////////////
+//
+// stepperRAHours
+//
+/////////////////////////////////
+// Convert an RA stepper position to hours, not counting the flip or wrap.
+float Mount::stepperRAHours(long position) const {
+  return -position / stepsPerSiderealHour;
+}
+
+/////////////////////////////////
+//
+// stepperDECDegrees
+//
+/////////////////////////////////
+// Convert a DEC stepper position to degrees. The pole is at 0 and DEC goes negative in
+// both directions of the stepper.
+float Mount::stepperDECDegrees(long position) const {
+  return -abs(position) / (float)stepsPerDECDegree;
+}
+
+/////////////////////////////////
+//
+// anchorCurrentPosition
+//
+/////////////////////////////////
+void Mount::anchorCurrentPosition() {
+  _currentRASteps = _stepperRA->currentPosition();
+  _currentDECSteps = _stepperDEC->currentPosition();
+  _anchorRA = _currentRA;
+  _anchorDEC = _currentDEC;
+  _anchorRASteps = _currentRASteps;
+  _anchorDECSteps = _currentDECSteps;
+  _anchorFlipped = isDECFlipped();
+}
+
+/////////////////////////////////
+//
+// updateCurrentPosition
+//
+// The stepper positions don't include tracking, they stay fixed on the sky. So the current position only
+// changes when the mount slews or guides, and then by a fixed amount per step (plus 12 hours of RA when DEC
+// crosses the pole). That is added to the anchor in whole DayTime units, which wrap RA and clamp DEC.
+/////////////////////////////////
+void Mount::updateCurrentPosition() {
+  long raSteps = _stepperRA->currentPosition();
+  long decSteps = _stepperDEC->currentPosition();
+  if ((raSteps == _currentRASteps) && (decSteps == _currentDECSteps)) {
+    return;
+  }
+  _currentRASteps = raSteps;
+  _currentDECSteps = decSteps;
+
+  // The RA stepper runs the opposite way.
+  long raUnits = (long)floor((_anchorRASteps - raSteps) * timeUnitsPerRAStep + 0.5f);
+  if (isDECFlipped() != _anchorFlipped) {
+    raUnits += 12L * TIME_UNITS_PER_HOUR;
+  }
+  _currentRA.setTotalUnits(_anchorRA.getTotalUnits() + raUnits);
+
+  // DEC is furthest from the pole at the ends of the stepper range, in both directions.
+  long decUnits = (long)floor((abs(_anchorDECSteps) - abs(decSteps)) * timeUnitsPerDECStep + 0.5f);
+  _currentDEC.setTotalUnits(_anchorDEC.getTotalUnits() + (NORTHERN_HEMISPHERE ? decUnits : -decUnits));
+}
+
+/////////////////////////////////
+//
+// isDECFlipped
+//
+/////////////////////////////////
+// Returns true if the DEC axis is turned past the pole, which means RA is 12h off.
+bool Mount::isDECFlipped() const {
+  long decPos = _stepperDEC->currentPosition();
+  if (decPos == 0) {
+    // At the pole, go by where we're headed.
+    decPos = _stepperDEC->targetPosition();
+  }
+  return decPos < 0;
+}
+
+/////////////////////////////////
+//
+// pierSide
+//
+/////////////////////////////////
+byte Mount::pierSide() const {
+  return isDECFlipped() ? PIER_SIDE_WEST : PIER_SIDE_EAST;
+}
+
+/////////////////////////////////
+//
+// syncRA
+//
+/////////////////////////////////
+// Set the current RA position to be the given time. We do this by adjusting HA by the
+// difference between the current RA and the RA that we were told we were actually at.
+void Mount::syncRA(const DayTime& ra) {
+#ifdef SUPPORT_ALIGNMENT
+  // The alignment stars were measured against the HA this changes.
+  clearAlignment();
+#endif
+
+  // Given the display RA coordinates...
+  updateCurrentPosition();
+  DayTime newRA = DayTime(ra);
+
+  // ... convert to the system RA values
+  newRA.subtractTime(_HACorrection);
+
+  // Calculate the difference between the new system RA and the current system RA
+  DayTime deltaRA = DayTime(newRA);
+  deltaRA.subtractTime(_currentRA);
+
+  // Now add this difference to HA.
+  DayTime newHA = DayTime(_HATime);
+  newHA.addTime(deltaRA);
+  setHA(newHA);
+
+  // Syncing doesn't move the mount, so it stays on the same side of the pier.
+  float targetRA, targetDEC;
+  calculateRAandDECSteppers(targetRA, targetDEC, pierSide());
+  _stepperRA->setCurrentPosition(targetRA);
+  anchorCurrentPosition();
+}
+
+/////////////////////////////////
+//
+// syncDEC
+//
+/////////////////////////////////
+// Set the current DEC position to be the given degrees (which are 0 .. -180 for Northern Hemisphere)
+void Mount::syncDEC(const DegreeTime& dec) {
+#ifdef SUPPORT_ALIGNMENT
+  clearAlignment();
+#endif
+  _currentDEC = dec;
+  _targetDEC = _currentDEC;
+  float targetRA, targetDEC;
+  calculateRAandDECSteppers(targetRA, targetDEC, pierSide());
+  _stepperDEC->setCurrentPosition(targetDEC);
+  anchorCurrentPosition();
+}
+
+#ifdef SUPPORT_ALIGNMENT
+/////////////////////////////////
+//
+// addAlignmentStar
+//
+/////////////////////////////////
+void Mount::addAlignmentStar() {
+  if (_alignmentCount == 0) {
+    // The first star syncs RA, so the next one is found more easily. That only turns the RA axis, which the model
+    // takes in its stride. Syncing DEC would offset its reading, which no turn of the axes can make up for.
+    DayTime ra(_targetRA);
+    ra.addTime(_HACorrection);
+    syncRA(ra);
+  }
+
+  // Where the axes point now, as if the mount was perfect. DEC tracks for the King rate.
+  float hourPos = stepperRAHours(_stepperRA->currentPosition());
+  if (isDECFlipped()) {
+    hourPos += 12.0f;
+  }
+  float decPos = stepperDECDegrees(_stepperDEC->currentPosition() + _stepperDEC->trackingPosition());
+  toAlignmentVector(hourPos, decPos, _alignmentMount[_nextAlignmentStar]);
+  toAlignmentVector(_targetRA.getTotalHours(), _targetDEC.getTotalDegrees(), _alignmentSky[_nextAlignmentStar]);
+
+  _nextAlignmentStar = (_nextAlignmentStar + 1) % ALIGNMENT_STARS;
+  if (_alignmentCount < ALIGNMENT_STARS) {
+    _alignmentCount++;
+  }
+  solveAlignment();
+}
+
+/////////////////////////////////
+//
+// clearAlignment
+//
+/////////////////////////////////
+void Mount::clearAlignment() {
+  _alignmentCount = 0;
+  _nextAlignmentStar = 0;
+  _alignmentStars = 0;
+}
+
+/////////////////////////////////
+//
+// alignmentStars
+//
+/////////////////////////////////
+byte Mount::alignmentStars() const {
+  return _alignmentStars;
+}
+
+/////////////////////////////////
+//
+// solveAlignment
+//
+// The model is a matrix that turns where a star is into where the axes point at it (Taki's method). With the
+// vectors of the stars as the columns of S and those of the axes as the columns of M, it is M * S^-1. Two stars
+// only fix two columns, so a third is made from their cross products. That model is a pure turn of the axes,
+// like polar misalignment. Three stars that are far enough apart also fit cone error and axes that are not square.
+/////////////////////////////////
+void Mount::solveAlignment() {
+  _alignmentStars = 0;
+  if (_alignmentCount < 2) {
+    return;
+  }
+
+  // Use the newest stars first
+  float sky[3][3];
+  float mount[3][3];
+  byte star = _nextAlignmentStar;
+  for (byte i = 0; i < _alignmentCount; i++) {
+    star = (star + ALIGNMENT_STARS - 1) % ALIGNMENT_STARS;
+    memcpy(sky[i], _alignmentSky[star], sizeof(sky[i]));
+    memcpy(mount[i], _alignmentMount[star], sizeof(mount[i]));
+  }
+
+  // The inverse of a matrix with rows a, b, c has columns b x c, c x a and a x b, divided by the determinant.
+  float inverse[3][3];
+  crossProduct(sky[1], sky[2], inverse[0]);
+  crossProduct(sky[2], sky[0], inverse[1]);
+  crossProduct(sky[0], sky[1], inverse[2]);
+  float det = sky[0][0] * inverse[0][0] + sky[0][1] * inverse[0][1] + sky[0][2] * inverse[0][2];
+  byte stars = 3;
+
+  // Three stars close to one great circle hardly fix the third column, so fall back to the newest two then.
+  if ((_alignmentCount < 3) || (fabs(det) < 0.05f)) {
+    stars = 2;
+    float skyLength = sqrt(inverse[2][0] * inverse[2][0] + inverse[2][1] * inverse[2][1] + inverse[2][2] * inverse[2][2]);
+    crossProduct(mount[0], mount[1], mount[2]);
+    float mountLength = sqrt(mount[2][0] * mount[2][0] + mount[2][1] * mount[2][1] + mount[2][2] * mount[2][2]);
+    if ((skyLength < 0.01f) || (mountLength < 0.01f)) {
+      // The stars are too close together (or opposite) to tell anything.
+      return;
+    }
+    for (byte i = 0; i < 3; i++) {
+      sky[2][i] = inverse[2][i] / skyLength;
+      mount[2][i] /= mountLength;
+    }
+    crossProduct(sky[1], sky[2], inverse[0]);
+    crossProduct(sky[2], sky[0], inverse[1]);
+    crossProduct(sky[0], sky[1], inverse[2]);
+    det = sky[0][0] * inverse[0][0] + sky[0][1] * inverse[0][1] + sky[0][2] * inverse[0][2];
+  }
+
+  for (byte i = 0; i < 3; i++) {
+    for (byte j = 0; j < 3; j++) {
+      _alignment[i][j] = (mount[0][i] * inverse[0][j] + mount[1][i] * inverse[1][j] + mount[2][i] * inverse[2][j]) / det;
+    }
+  }
+  _alignmentStars = stars;
+}
+
+/////////////////////////////////
+//
+// applyAlignment
+//
+/////////////////////////////////
+void Mount::applyAlignment(float& hourPos, float& decPos) const {
+  float v[3];
+  float r[3];
+  toAlignmentVector(hourPos, decPos, v);
+  for (byte i = 0; i < 3; i++) {
+    r[i] = _alignment[i][0] * v[0] + _alignment[i][1] * v[1] + _alignment[i][2] * v[2];
+  }
+  fromAlignmentVector(r, hourPos, decPos);
+}
+
+/////////////////////////////////
+//
+// toAlignmentVector
+//
+// The model works in hour angle, which stays fixed to the mount while the sky turns. The RA ring has turned
+// with the sky by the tracked steps, so that is where the hour angle of a target RA is measured from.
+/////////////////////////////////
+void Mount::toAlignmentVector(float hourPos, float decPos, float v[3]) const {
+  float ha = (_stepperRA->trackingPosition() / calibratedStepsPerSiderealHour() - hourPos) * 15.0f * DEG_TO_RAD;
+  float dec = (decPos + (NORTHERN_HEMISPHERE ? 90 : -90)) * DEG_TO_RAD;
+  v[0] = cos(dec) * cos(ha);
+  v[1] = cos(dec) * sin(ha);
+  v[2] = sin(dec);
+}
+
+/////////////////////////////////
+//
+// fromAlignmentVector
+//
+/////////////////////////////////
+void Mount::fromAlignmentVector(const float v[3], float& hourPos, float& decPos) const {
+  hourPos = _stepperRA->trackingPosition() / calibratedStepsPerSiderealHour() - atan2(v[1], v[0]) * RAD_TO_DEG / 15.0f;
+  while (hourPos < 0.0f) hourPos += 24.0f;
+  while (hourPos >= 24.0f) hourPos -= 24.0f;
+  decPos = atan2(v[2], sqrt(v[0] * v[0] + v[1] * v[1])) * RAD_TO_DEG - (NORTHERN_HEMISPHERE ? 90 : -90);
+}
+
+/////////////////////////////////
+//
+// getAlignmentErrors
+//
+/////////////////////////////////
+void Mount::getAlignmentErrors(float& poleUp, float& poleWest, float& skew) const {
+  poleUp = 0;
+  poleWest = 0;
+  skew = 0;
+  if (_alignmentStars == 0) {
+    return;
+  }
+
+  // The model turns the celestial pole into its third column (negated in the south), as seen from the RA axis.
+  const float arcminutes = RAD_TO_DEG * 60.0f;
+  float pole = NORTHERN_HEMISPHERE ? 1.0f : -1.0f;
+  poleUp = asin(clamp(pole * _alignment[0][2], -1.0f, 1.0f)) * arcminutes;
+  poleWest = asin(clamp(pole * _alignment[1][2], -1.0f, 1.0f)) * arcminutes;
+
+  // The columns are where the sky's axes end up. A mount that is only turned keeps them square.
+  for (byte i = 0; i < 3; i++) {
+    byte j = (i + 1) % 3;
+    float dot = 0;
+    float lengthI = 0;
+    float lengthJ = 0;
+    for (byte k = 0; k < 3; k++) {
+      dot += _alignment[k][i] * _alignment[k][j];
+      lengthI += _alignment[k][i] * _alignment[k][i];
+      lengthJ += _alignment[k][j] * _alignment[k][j];
+    }
+    float angle = asin(clamp(fabs(dot) / sqrt(lengthI * lengthJ), 0.0f, 1.0f)) * arcminutes;
+    skew = max(skew, angle);
+  }
+}
+#endif
+
+/////////////////////////////////
+//
+// startSlewingToTarget
+//
+/////////////////////////////////
+// Calculates movement parameters and program steppers to move
+// there. Must call loop() frequently to actually move.
+void Mount::startSlewingToTarget() {
+  slewToTarget(true);
+}
+
+/////////////////////////////////
+//
+// startSlewingToHome
+//
+/////////////////////////////////
+void Mount::startSlewingToHome() {
+  setTargetToHome();
+  slewToTarget(false);
+}
+
+/////////////////////////////////
+//
+// slewToTarget
+//
+/////////////////////////////////
+void Mount::slewToTarget(bool aligned) {
+  if (isGuiding()) {
+    stopGuiding();
+  }
+
+  // The King rate corrects DEC for refraction where the mount was pointing, which does not apply to the target.
+  // That doesn't move the mount, so the current position stays where it is.
+  updateCurrentPosition();
+  _stepperDEC->addTrackingToPosition();
+  anchorCurrentPosition();
+
+  // Calculate new RA stepper target (and DEC), on the side of the pier that gets there quickest.
+  // If we can't get there without physical issues, don't even start, the steppers would only stop at the limit.
+  float targetRA, targetDEC;
+  _isUnreachable = !calculateRAandDECSteppers(targetRA, targetDEC, PIER_SIDE_AUTO, aligned);
+  if (_isUnreachable) {
+    return;
+  }
+  moveSteppersTo(targetRA, targetDEC);
+
+  _mountStatus |= STATUS_SLEWING | STATUS_SLEWING_TO_TARGET;
+  _totalDECMove = 1.0f * _stepperDEC->distanceToGo();
+  _totalRAMove = 1.0f * _stepperRA->distanceToGo();
+}
+
+/////////////////////////////////
+//
+// slewDuration
+//
+/////////////////////////////////
+float Mount::slewDuration() const {
+  return _slewDuration;
+}
+
+/////////////////////////////////
+//
+// slewTimeRemaining
+//
+/////////////////////////////////
+float Mount::slewTimeRemaining() const {
+  float elapsed = (millis() - _slewStartTime) / 1000.0f;
+  return max(0.0f, _slewDuration - elapsed);
+}
+
+/////////////////////////////////
+//
+// stopGuiding
+//
+/////////////////////////////////
+void Mount::stopGuiding(bool ra, bool dec) {
+  // Both axes guide in speed mode, which stops on the spot. The current position has followed the guided steps.
+  if (dec && (_mountStatus & STATUS_GUIDE_PULSE_DEC)) {
+    _stepperDEC->stop();
+    _mountStatus &= ~STATUS_GUIDE_PULSE_DEC;
+  }
+
+  if (ra && (_mountStatus & STATUS_GUIDE_PULSE_RA)) {
+    _stepperRA->stop();
+    _mountStatus &= ~STATUS_GUIDE_PULSE_RA;
+  }
+
+  if ((_mountStatus & STATUS_GUIDE_PULSE_DIR) == 0) {
+    _mountStatus &= ~STATUS_GUIDE_PULSE;
+  }
+}
+
+/////////////////////////////////
+//
+// guidePulse
 //
 /////////////////////////////////
-void Mount::setHACorrection(int h, int m, int s) {
-  _HAAdjust.set(h, m, s);
+void Mount::guidePulse(byte direction, int duration) {
+  // Guiding uses the same motor channel as slewing, so pulses that come in while the mount
+  // is slewing or running a job are ignored. Tracking is not touched.
+  if (_mountStatus & (STATUS_SLEWING | STATUS_STOPPING | STATUS_JOB_MASK | STATUS_DRIFT_ALIGNING)) {
+    return;
+  }
+
+  // Both axes move at the guide rate (a fraction of the calibrated sidereal rate). For RA, this is on
+  // top of tracking, so the motor runs faster (west) or slower (east) than tracking.
+  // The steppers keep the fraction of a step left over at the end of a pulse, so the next pulse
+  // (in either direction) starts from there. That way short pulses aren't lost.
+  // Each axis has its own pulse, so an RA and a DEC pulse can run at the same time. A new pulse
+  // on an axis that is still guiding replaces the old one.
+  // The guide steps are not tracking steps, they move the mount coordinate (and so the current position).
+  // Time the pulse in microseconds. Comparing the elapsed time (rather than the end time) keeps
+  // working when micros() wraps around, every 70 minutes.
+  switch (direction) {
+    case NORTH:
+    case SOUTH:
+    stopGuiding(false, true);
+    _stepperDEC->setStepRate((uint64_t)_siderealRate * stepsPerDECDegree * _guideRateDEC / ((uint64_t)stepsPerRADegree * MAX_GUIDE_RATE), direction == NORTH ? 1 : -1);
+    _guideStartTimeDEC = micros();
+    _guideDurationDEC = duration * 1000UL;
+    _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_DEC;
+    break;
+
+    case WEST:
+    case EAST:
+    stopGuiding(true, false);
+    _stepperRA->setStepRate((uint64_t)_siderealRate * _guideRateRA / MAX_GUIDE_RATE, direction == WEST ? 1 : -1);
+    _guideStartTimeRA = micros();
+    _guideDurationRA = duration * 1000UL;
+    _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_RA;
+#ifdef SUPPORT_PEC
+    long eighths = (long)(duration * _trackingSpeed * _guideRateRA * 8 / (1000L * MAX_GUIDE_RATE * raStepFactor));
+    recordPECCorrection(direction == WEST ? eighths : -eighths);
+#endif
+    break;
+  }
 }
 
 /////////////////////////////////
 //
-// getHACorrection
+// startDriftAlignment
 //
 /////////////////////////////////
-DayTime Mount::getHACorrection() {
-  return _HAAdjust;
+void Mount::startDriftAlignment(int durationSecs, long steps) {
+  if (_mountStatus & (STATUS_JOB_MASK | STATUS_DRIFT_ALIGNING)) {
+    return;
+  }
+
+  stopGuiding();
+  stopSlewing(TRACKING);
+
+  _driftDuration = max(durationSecs, 1);
+  _driftSteps = steps * raStepFactor;
+  _driftStartPosition = _stepperRA->currentPosition();
+  _driftPhase = DRIFT_PAUSE_START;
+#ifdef SUPPORT_PEC
+  // The drift moves would end up in a recording. Playing a table back is fine.
+  if (_pecStatus == PEC_RECORDING) {
+    stopPEC();
+  }
+#endif
+  _driftPhaseStart = millis();
+  _mountStatus |= STATUS_DRIFT_ALIGNING | STATUS_DRIFT_TRACKING;
 }
+
 /////////////////////////////////
 //
-// HA
+// stopDriftAlignment
 //
 /////////////////////////////////
-const DayTime& Mount::HA() const {
-  return _HATime;
+void Mount::stopDriftAlignment(bool resumeTracking) {
+  if (!isDriftAligning()) {
+    return;
+  }
+
+  if (!resumeTracking) {
+    _mountStatus &= ~STATUS_DRIFT_TRACKING;
+  }
+
+  // Head back to where we started at full speed. loop() finishes up once we're there.
+  _stepperRA->setMaxSpeed(raMaxSpeed);
+  _stepperRA->setAcceleration(raAcceleration);
+  _stepperRA->moveTo(_driftStartPosition);
+  _driftPhase = DRIFT_RETURNING;
 }
 
 /////////////////////////////////
 //
-// targetRA
+// isDriftAligning
 //
 /////////////////////////////////
-// Get a reference to the target RA value.
-DayTime& Mount::targetRA() {
-  return _targetRA;
+bool Mount::isDriftAligning() const {
+  return _mountStatus & STATUS_DRIFT_ALIGNING;
 }
 
 /////////////////////////////////
 //
-// targetDEC
+// driftAlignmentPhase
 //
 /////////////////////////////////
-// Get a reference to the target DEC value.
-DegreeTime& Mount::targetDEC() {
-  return _targetDEC;
+byte Mount::driftAlignmentPhase() const {
+  return _driftPhase;
 }
 
 /////////////////////////////////
 //
-// currentRA
+// runDriftAlignment
 //
+// Called from loop() while drift aligning. Each phase is either a pause or a move of the RA
+// motor. Once the pause has passed or the move is done, this starts the next phase. The slack
+// in the gears when RA reverses is taken up by the backlash compensation of the stepper.
 /////////////////////////////////
-// Get current RA value.
-const DayTime Mount::currentRA() const {
-  if (!isSlewingRA() || (_mountStatus & STATUS_SLEWING_TO_TARGET) == 0) return _currentRA;
+void Mount::runDriftAlignment() {
+  if (_stepperRA->isRunning()) {
+    return;
+  }
 
-  // How many steps are needed between current and target
-  long deltaSteps = _stepperRA->targetPosition() - _currentRAStepperPosition;
+  unsigned long now = millis();
+  bool pausing = (_driftPhase == DRIFT_PAUSE_START) || (_driftPhase == DRIFT_PAUSE_MIDDLE) || (_driftPhase == DRIFT_PAUSE_END);
+  if (pausing && (now - _driftPhaseStart < DRIFT_PAUSE_TIME)) {
+    return;
+  }
 
-  // Calculate how far along (0..1) we are
-  float alongPathNormalized = 1.0 * (_stepperRA->currentPosition() - _currentRAStepperPosition) / deltaSteps;
+  // The speed at which it takes the given duration to cover the steps.
+  float speed = 1.0f * _driftSteps / _driftDuration;
 
-  float raT = _targetRA.getTotalHours();
-  float raC = _currentRA.getTotalHours();
-  float deltaT = raT - raC;
+  switch (_driftPhase) {
+    case DRIFT_PAUSE_START:
+    // Move east at the calculated speed
+    _stepperRA->setAcceleration(3000);
+    _stepperRA->setMaxSpeed(speed);
+    _stepperRA->move(_driftSteps);
+    break;
 
-  // If we're rolling over, take the short route. i.e. if the motor direction indicates
-  // the other direction than the math, move the target beyond current in the right direction
-  if ((raT < raC && (deltaSteps < 0)) || (raT > raC && (deltaSteps > 0))) {
-    raT += (deltaSteps < 0) ? 24 : -24;
-    deltaT = raT - raC;
-  }
+    case DRIFT_PAUSE_MIDDLE:
+    // Move west at the calculated speed
+    _stepperRA->setMaxSpeed(speed);
+    _stepperRA->move(-_driftSteps);
+    break;
 
-  // Move the RA along by wher we are, fractionally
-  raC += deltaT * alongPathNormalized;
+    case DRIFT_PAUSE_END:
+    case DRIFT_RETURNING:
+    // Done. Re-configure the stepper to the correct parameters.
+    _stepperRA->setAcceleration(raAcceleration);
+    _stepperRA->setMaxSpeed(raMaxSpeed);
+    _mountStatus &= ~STATUS_DRIFT_ALIGNING;
+    if (_mountStatus & STATUS_DRIFT_TRACKING) {
+      _mountStatus &= ~STATUS_DRIFT_TRACKING;
+      startSlewing(TRACKING);
+    }
+    return;
+  }
 
-  return raC;
+  _driftPhase++;
+  _driftPhaseStart = now;
 }
 
+#ifdef SUPPORT_PEC
 /////////////////////////////////
 //
-// currentDEC
+// startPECRecording
 //
 /////////////////////////////////
-// Get current DEC value.
-const DegreeTime Mount::currentDEC() const {
-  if (!isSlewingDEC() || (_mountStatus & STATUS_SLEWING_TO_TARGET) == 0) return _currentDEC;
-
-  // How many steps are needed between current and target
-  long deltaSteps = _stepperDEC->targetPosition() - _currentDECStepperPosition;
-
-  // Calculate how far along (0..1) we are
-  float alongPathNormalized = 1.0 * (_stepperDEC->currentPosition() - _currentDECStepperPosition) / deltaSteps;
-
-  float decT = _targetDEC.getTotalDegrees();
-  float decC = _currentDEC.getTotalDegrees();
-  float deltaT = decT - decC;
-  decC += deltaT * alongPathNormalized;
-  return decC;
+void Mount::startPECRecording() {
+  stopPEC();
+  _pecSums = new int[CORRECTION_TABLE_SIZE];
+  for (byte i = 0; i < CORRECTION_TABLE_SIZE; i++) {
+    _pecSums[i] = 0;
+  }
+  _pecRecordStart = _stepperRA->motorPosition();
+  _pecStatus = PEC_RECORDING;
 }
 
 /////////////////////////////////
 //
-// syncRA
+// recordPECCorrection
 //
 /////////////////////////////////
-// Set the current RA position to be the given time. We do this by adjusting HA by the
-// difference between the current RA and the RA that we were told we were actually at.
-void Mount::syncRA(int hour, int minute, int second) {
-  // Given the display RA coordinates...
-  DayTime newRA = DayTime(hour, minute, second);
-
-  // ... convert to the system RA values
-  newRA.subtractTime(_HACorrection);
-
-  // Calculate the difference between the new system RA and the current system RA
-  DayTime deltaRA = DayTime(newRA);
-  deltaRA.subtractTime(_currentRA);
-
-  // Now add this difference to HA.
-  DayTime newHA = DayTime(_HATime);
-  newHA.addTime(deltaRA);
-  setHA(newHA);
+void Mount::recordPECCorrection(long eighths) {
+  if (_pecStatus != PEC_RECORDING) {
+    return;
+  }
 
-  float targetRA, targetDEC;
-  calculateRAandDECSteppers(targetRA, targetDEC);
-  _stepperRA->setCurrentPosition(targetRA);
+  byte index = (_stepperRA->motorPosition() >> (CORRECTION_STEP_BITS + raMicrostepBits)) & (CORRECTION_TABLE_SIZE - 1);
+  _pecSums[index] = constrain(_pecSums[index] + eighths, -32000L, 32000L);
 }
 
 /////////////////////////////////
 //
-// syncDEC
+// finishPECRecording
 //
 /////////////////////////////////
-// Set the current DEC position to be the given degrees (which are 0 .. -180 for Northern Hemisphere)
-void Mount::syncDEC(int degree, int minute, int second) {
-  _currentDEC = DegreeTime(degree, minute, second);
-  _targetDEC = _currentDEC;
-  float targetRA, targetDEC;
-  calculateRAandDECSteppers(targetRA, targetDEC);
-  _stepperDEC->setCurrentPosition(targetDEC);
+void Mount::finishPECRecording() {
+  // Average the cycles, and take out the mean so that the table doesn't change the overall tracking speed.
+  long total = 0;
+  for (byte i = 0; i < CORRECTION_TABLE_SIZE; i++) {
+    total += _pecSums[i];
+  }
+  int mean = total / CORRECTION_TABLE_SIZE;
+
+  _stepperRA->setTrackingCorrection(NULL);
+  EEPROM.update(PEC_EEPROM_ADDRESS, PEC_EEPROM_MARKER);
+  for (byte i = 0; i < CORRECTION_TABLE_SIZE; i++) {
+    _pecTable[i] = constrain((_pecSums[i] - mean) / PEC_RECORD_CYCLES, -127, 127);
+    EEPROM.update(PEC_EEPROM_ADDRESS + 1 + i, (byte)_pecTable[i]);
+  }
+  _pecValid = true;
+
+  delete[] _pecSums;
+  _pecSums = NULL;
+  _pecStatus = PEC_OFF;
+  startPECPlayback();
 }
 
 /////////////////////////////////
 //
-// startSlewingToTarget
+// startPECPlayback
 //
 /////////////////////////////////
-// Calculates movement parameters and program steppers to move
-// there. Must call loop() frequently to actually move.
-void Mount::startSlewingToTarget() {
-  if (isGuiding()) {
-    stopGuiding();
+void Mount::startPECPlayback() {
+  if (_pecValid && (_pecStatus == PEC_OFF)) {
+    _stepperRA->setTrackingCorrection(_pecTable, raMicrostepBits);
+    _pecStatus = PEC_PLAYING;
   }
-
-  // Calculate new RA stepper target (and DEC)
-  _currentDECStepperPosition = _stepperDEC->currentPosition();
-  _currentRAStepperPosition = _stepperRA->currentPosition();
-  float targetRA, targetDEC;
-  calculateRAandDECSteppers(targetRA, targetDEC);
-  moveSteppersTo(targetRA, targetDEC);
-
-  _mountStatus |= STATUS_SLEWING | STATUS_SLEWING_TO_TARGET;
-  _totalDECMove = 1.0f * _stepperDEC->distanceToGo();
-  _totalRAMove = 1.0f * _stepperRA->distanceToGo();
 }
 
 /////////////////////////////////
 //
-// stopGuiding
+// stopPEC
 //
 /////////////////////////////////
-void Mount::stopGuiding() {
-  _stepperDEC->stop();
-  while (_stepperDEC->isRunning()) {
-    _stepperDEC->run();
+void Mount::stopPEC() {
+  _stepperRA->setTrackingCorrection(NULL);
+  if (_pecSums != NULL) {
+    delete[] _pecSums;
+    _pecSums = NULL;
   }
-
-  _stepperDEC->setMaxSpeed(_maxDECSpeed);
-  _stepperDEC->setAcceleration(_maxDECAcceleration);
-  _stepperTRK->setMaxSpeed(10);
-  _stepperTRK->setAcceleration(2500);
-  _stepperTRK->setSpeed(_trackingSpeed);
-  _mountStatus &= ~STATUS_GUIDE_PULSE_MASK;
+  _pecStatus = PEC_OFF;
 }
 
 /////////////////////////////////
 //
-// guidePulse
+// loadPEC
 //
+// The table is indexed by motor position, which starts at 0 when the tracker is switched on. So it
+// only lines up with the gears if the tracker was parked (or homed) when it was switched off.
 /////////////////////////////////
-void Mount::guidePulse(byte direction, int duration) {
-  // DEC stepper moves at sidereal rate in both directions
-  // RA stepper moves at either 2x sidereal rate or stops.
-  // TODO: Do we need to adjust with _trackingSpeedCalibration?
-  float decTrackingSpeed = _stepsPerDECDegree * siderealDegreesInHour / 3600.0f;
-  float raTrackingSpeed = _stepsPerRADegree * siderealDegreesInHour / 3600.0f;
-
-  // TODO: Do we need to track how many steps the steppers took and add them to the GoHome calculation?
-  // If so, we need to remember where we were when we started the guide pulse. Then at the end,
-  // we can calculate the difference.
-  // long raPos = _stepperTRK->currentPosition();
-  // long decPos = _stepperDEC->currentPosition();
-
-  switch (direction) {
-    case NORTH:
-    _stepperDEC->setAcceleration(2500);
-    _stepperDEC->setMaxSpeed(decTrackingSpeed * 1.2);
-    _stepperDEC->setSpeed(decTrackingSpeed);
-    _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_DEC;
-    break;
-
-    case SOUTH:
-    _stepperDEC->setAcceleration(2500);
-    _stepperDEC->setMaxSpeed(decTrackingSpeed * 1.2);
-    _stepperDEC->setSpeed(-decTrackingSpeed);
-    _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_DEC;
-    break;
-
-    case WEST:
-    _stepperTRK->setMaxSpeed(raTrackingSpeed * 2.2);
-    _stepperTRK->setSpeed(raTrackingSpeed * 2);
-    _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_RA;
-    break;
-
-    case EAST:
-    _stepperTRK->setMaxSpeed(raTrackingSpeed * 2.2);
-    _stepperTRK->setSpeed(0);
-    _mountStatus |= STATUS_GUIDE_PULSE | STATUS_GUIDE_PULSE_RA;
-    break;
+void Mount::loadPEC() {
+  stopPEC();
+  _pecValid = (EEPROM.read(PEC_EEPROM_ADDRESS) == PEC_EEPROM_MARKER);
+  if (_pecValid) {
+    for (byte i = 0; i < CORRECTION_TABLE_SIZE; i++) {
+      _pecTable[i] = (int8_t)EEPROM.read(PEC_EEPROM_ADDRESS + 1 + i);
+    }
+    startPECPlayback();
   }
-
-  _guideEndTime = millis() + duration;
 }
 
 /////////////////////////////////
 //
-// runDriftAlignmentPhase
+// pecStatus
 //
-// Runs one of the phases of the Drift alignment
-// This runs the RA motor 400 steps (about 5.3 arcminutes) in the given duration
-// This function should be callsed 3 times:
-// The first time with EAST, second with WEST and then with 0.
 /////////////////////////////////
-void Mount::runDriftAlignmentPhase(int direction, int durationSecs) {
-  // Calculate the speed at which it takes the given duration to cover 400 steps.
-  float speed = 400.0 / durationSecs;
-  switch (direction) {
-    case EAST:
-    // Move 400 steps east at the calculated speed, synchronously
-    _stepperRA->setAcceleration(1500);
-    _stepperRA->setMaxSpeed(speed);
-    _stepperRA->move(400);
-    _stepperRA->runToPosition();
-
-    // Overcome the gearing gap
-    _stepperRA->setMaxSpeed(300);
-    _stepperRA->move(-20);
-    _stepperRA->runToPosition();
-    break;
-
-    case WEST:
-    // Move 400 steps west at the calculated speed, synchronously
-    _stepperRA->setMaxSpeed(speed);
-    _stepperRA->move(-400);
-    _stepperRA->runToPosition();
-    break;
-
-    case 0:
-    // Fix the gearing to go back the other way
-    _stepperRA->setMaxSpeed(300);
-    _stepperRA->move(20);
-    _stepperRA->runToPosition();
-
-    // Re-configure the stepper to the correct parameters.
-    _stepperRA->setAcceleration(_maxRAAcceleration);
-    _stepperRA->setMaxSpeed(_maxRASpeed);
-    break;
-  }
+byte Mount::pecStatus() const {
+  return _pecStatus;
 }
+#endif
 
 /////////////////////////////////
 //
 // park
 //
-// Targets the mount to move to the home position and
-// turns off all motors once it gets there.
+// Asynchronously stops the mount, moves it to the home position and
+// turns off all motors once it gets there. loop() runs the job.
 /////////////////////////////////
 void Mount::park() {
   stopGuiding();
   stopSlewing(ALL_DIRECTIONS | TRACKING);
-  waitUntilStopped(ALL_DIRECTIONS);
-  setTargetToHome();
-  startSlewingToTarget();
-  _mountStatus |= STATUS_PARKING;
+  _mountStatus &= ~(STATUS_FINDING_HOME | STATUS_HOME_TRACKING);
+  _mountStatus |= STATUS_PARKING | STATUS_STOPPING;
 }
 
 /////////////////////////////////
 //
 // goHome
 //
-// Synchronously moves mount to home position and
-// sets Tracking mode according to argument
+// Asynchronously moves mount to home position and sets Tracking
+// mode according to argument once it gets there. loop() runs the job.
 /////////////////////////////////
 void Mount::goHome(bool tracking)
 {
   stopGuiding();
-  stopSlewing(TRACKING);
-  setTargetToHome();
-  startSlewingToTarget();
-  waitUntilStopped(ALL_DIRECTIONS);
-  setHome();
-  if (tracking) {
-    startSlewing(TRACKING);
-  }
+  stopSlewing(ALL_DIRECTIONS | TRACKING);
+  _mountStatus &= ~(STATUS_PARKING | STATUS_HOME_TRACKING);
+  _mountStatus |= STATUS_FINDING_HOME | STATUS_STOPPING | (tracking ? STATUS_HOME_TRACKING : 0);
 }
 
 /////////////////////////////////
@@ -445,7 +1453,7 @@ void Mount::goHome(bool tracking)
 // mountStatus
 //
 /////////////////////////////////
-byte Mount::mountStatus() {
+int Mount::mountStatus() {
   return _mountStatus;
 }
 
@@ -463,6 +1471,15 @@ String Mount::mountStatusString() {
   if (_mountStatus & STATUS_PARKING) {
     disp = "PARKNG ";
   }
+  else if (_mountStatus & STATUS_FINDING_HOME) {
+    disp = "HOMING ";
+  }
+  else if (_mountStatus & STATUS_DRIFT_ALIGNING) {
+    disp = "DRIFT" + String(_driftPhase) + " ";
+  }
+  else if (_mountStatus & STATUS_STOPPING) {
+    disp = "STOPNG ";
+  }
   else if (isGuiding()) {
     disp = "GUIDING ";
   }
@@ -482,7 +1499,11 @@ String Mount::mountStatusString() {
 
   disp += " RA:" + String(_stepperRA->currentPosition());
   disp += " DEC:" + String(_stepperDEC->currentPosition());
-  disp += " TRK:" + String(_stepperTRK->currentPosition());
+  disp += " TRK:" + String(_stepperRA->trackingPosition());
+  disp += " ISR:" + String(InterruptStepper::maxTickDuration()) + "us";
+  if (atLimit() != 0) {
+    disp += " LIMIT";
+  }
 
   return disp;
 }
@@ -501,6 +1522,15 @@ String Mount::getStatusString() {
   else if (_mountStatus & STATUS_PARKING) {
     status = "Parking,";
   }
+  else if (_mountStatus & STATUS_FINDING_HOME) {
+    status = "Homing,";
+  }
+  else if (_mountStatus & STATUS_DRIFT_ALIGNING) {
+    status = "DriftAlign,";
+  }
+  else if (_mountStatus & STATUS_STOPPING) {
+    status = "Stopping,";
+  }
   else if (isGuiding()) {
     status = "Guiding,";
   }
@@ -533,7 +1563,7 @@ String Mount::getStatusString() {
   status += disp;
   status += String(_stepperRA->currentPosition()) + ",";
   status += String(_stepperDEC->currentPosition()) + ",";
-  status += String(_stepperTRK->currentPosition()) + ",";
+  status += String(_stepperRA->trackingPosition()) + ",";
 
   status += RAString(COMPACT_STRING | CURRENT_STRING) + ",";
   status += DECString(COMPACT_STRING | CURRENT_STRING) + ",";
@@ -578,7 +1608,7 @@ bool Mount::isGuiding()const
 //
 /////////////////////////////////
 bool Mount::isSlewingDEC() const {
-  if (isParking()) return true;
+  if (_mountStatus & STATUS_JOB_MASK) return true;
   return (slewStatus() & SLEWING_DEC) != 0;
 }
 
@@ -588,7 +1618,7 @@ bool Mount::isSlewingDEC() const {
 //
 /////////////////////////////////
 bool Mount::isSlewingRA() const {
-  if (isParking()) return true;
+  if (_mountStatus & STATUS_JOB_MASK) return true;
   return (slewStatus() & SLEWING_RA) != 0;
 }
 
@@ -598,7 +1628,7 @@ bool Mount::isSlewingRA() const {
 //
 /////////////////////////////////
 bool Mount::isSlewingRAorDEC() const {
-  if (isParking()) return true;
+  if (_mountStatus & STATUS_JOB_MASK) return true;
   return (slewStatus() & (SLEWING_DEC | SLEWING_RA)) != 0;
 }
 
@@ -608,7 +1638,7 @@ bool Mount::isSlewingRAorDEC() const {
 //
 /////////////////////////////////
 bool Mount::isSlewingIdle() const {
-  if (isParking()) return false;
+  if (_mountStatus & STATUS_JOB_MASK) return false;
   return (slewStatus() & (SLEWING_DEC | SLEWING_RA)) == 0;
 }
 
@@ -639,41 +1669,68 @@ bool Mount::isParking() const {
   return _mountStatus & STATUS_PARKING;
 }
 
+/////////////////////////////////
+//
+// isFindingHome
+//
+/////////////////////////////////
+bool Mount::isFindingHome() const {
+  return _mountStatus & STATUS_FINDING_HOME;
+}
+
+/////////////////////////////////
+//
+// isStopping
+//
+/////////////////////////////////
+bool Mount::isStopping() const {
+  return _mountStatus & STATUS_STOPPING;
+}
+
 /////////////////////////////////
 //
 // startSlewing
 //
 // Starts manual slewing in one of eight directions or
-// tracking, but only if not currently parking!
+// tracking, but only if not currently parking, finding home or drift aligning!
 /////////////////////////////////
 void Mount::startSlewing(int direction) {
-  if (!isParking())
+  if ((_mountStatus & (STATUS_JOB_MASK | STATUS_DRIFT_ALIGNING)) == 0)
   {
     if (isGuiding()) {
       stopGuiding();
     }
 
     if (direction & TRACKING) {
-      _stepperTRK->setSpeed(_trackingSpeed);
-
       // Turn on tracking
       _mountStatus |= STATUS_TRACKING;
+#ifdef SUPPORT_KING_RATE
+      if (_trackingRateMode == TRACKING_KING) {
+        updateKingRate();
+        _lastKingUpdate = millis();
+      }
+#endif
+      _stepperRA->setTrackingRate(_trackingRate, 1);
     }
     else {
+      // Manual slews always run at full speed, for up to half a turn (the limits stop them before that).
+      // This is in degrees, so it is the same with any driver or microstepping.
+      resetSlewSpeeds();
+
       if (direction & NORTH) {
-        _stepperDEC->moveTo(30000);
+        _stepperDEC->moveTo(180L * stepsPerDECDegree);
         _mountStatus |= STATUS_SLEWING;
       }
       if (direction & SOUTH) {
-        _stepperDEC->moveTo(-30000);
+        _stepperDEC->moveTo(-180L * stepsPerDECDegree);
         _mountStatus |= STATUS_SLEWING;
       }
       if (direction & EAST) {
-        _stepperRA->moveTo(-30000);
+        _stepperRA->moveTo(-180L * stepsPerRADegree);
         _mountStatus |= STATUS_SLEWING;
       }
       if (direction & WEST) {
-        _stepperRA->moveTo(30000);
+        _stepperRA->moveTo(180L * stepsPerRADegree);
         _mountStatus |= STATUS_SLEWING;
       }
     }
@@ -691,7 +1748,8 @@ void Mount::stopSlewing(int direction) {
     // Turn off tracking
     _mountStatus &= ~STATUS_TRACKING;
 
-    _stepperTRK->stop();
+    _stepperRA->setTrackingRate(0, 1);
+    _stepperDEC->setTrackingRate(0, 1);
   }
 
   if ((direction & (NORTH | SOUTH)) != 0) {
@@ -700,6 +1758,15 @@ void Mount::stopSlewing(int direction) {
   if ((direction & (WEST | EAST)) != 0) {
     _stepperRA->stop();
   }
+
+  if ((direction & ALL_DIRECTIONS) == ALL_DIRECTIONS) {
+    // Stopping all the motors also cancels a park or go home, otherwise loop() would just start it again.
+    _mountStatus &= ~(STATUS_JOB_MASK | STATUS_HOME_TRACKING);
+  }
+
+  if ((direction & ALL_DIRECTIONS) && (_stepperRA->isRunning() || _stepperDEC->isRunning())) {
+    _mountStatus |= STATUS_STOPPING;
+  }
 }
 
 /////////////////////////////////
@@ -709,9 +1776,9 @@ void Mount::stopSlewing(int direction) {
 /////////////////////////////////
 // Block until the RA and DEC motors are stopped
 void Mount::waitUntilStopped(byte direction) {
+  // Tracking starts and stops right away, so there's nothing to wait for there.
   while (((direction & (EAST | WEST)) && _stepperRA->isRunning())
          || ((direction & (NORTH | SOUTH)) && _stepperDEC->isRunning())
-         || ((direction & TRACKING) && (((_mountStatus & STATUS_TRACKING) == 0) && _stepperTRK->isRunning()))
          ) {
     loop();
   }
@@ -724,7 +1791,7 @@ void Mount::waitUntilStopped(byte direction) {
 /////////////////////////////////
 long Mount::getCurrentStepperPosition(int direction) {
   if (direction & TRACKING) {
-    return _stepperTRK->currentPosition();
+    return _stepperRA->trackingPosition();
   }
   if (direction & (NORTH | SOUTH)) {
     return _stepperDEC->currentPosition();
@@ -752,7 +1819,8 @@ void Mount::delay(int ms) {
 //
 // loop
 //
-// Process any stepper movement. Must be called frequently
+// Process any stepper state changes. Must be called frequently.
+// The steppers are moved by the timer interrupt, this only keeps the mount status up to date.
 /////////////////////////////////
 void Mount::loop() {
   bool raStillRunning = false;
@@ -765,56 +1833,80 @@ void Mount::loop() {
     _lastMountPrint = now;
   }
 #endif
+  // The RA stepper stops tracking when it reaches its limit, so stop the mount tracking as well.
+  if ((_mountStatus & STATUS_TRACKING) && (_stepperRA->atLimit() > 0)) {
+    stopSlewing(TRACKING);
+  }
+
+  if (now - _lastSiderealUpdate >= 1000) {
+    updateSiderealTime();
+    _lastSiderealUpdate = now;
+  }
+
+#ifdef SUPPORT_KING_RATE
+  if ((_mountStatus & STATUS_TRACKING) && (_trackingRateMode == TRACKING_KING) && (now - _lastKingUpdate >= KING_RATE_INTERVAL)) {
+    updateKingRate();
+    _lastKingUpdate = now;
+  }
+#endif
+
+  // Each axis ends its own guide pulse. Guiding never runs during a slew, so the rest of the loop
+  // still needs to run (and ignores the guiding axes).
   if (isGuiding()) {
-    if (millis() > _guideEndTime) {
-      stopGuiding();
-    }
-    else
-    {
-      if (_mountStatus & STATUS_GUIDE_PULSE_RA) {
-        _stepperTRK->runSpeed();
-      }
-      if (_mountStatus & STATUS_GUIDE_PULSE_DEC) {
-        _stepperDEC->runSpeed();
-      }
-    }
-    return;
+    unsigned long nowMicros = micros();
+    stopGuiding(nowMicros - _guideStartTimeRA >= _guideDurationRA, nowMicros - _guideStartTimeDEC >= _guideDurationDEC);
   }
 
-  if (_mountStatus & STATUS_TRACKING) {
-    _stepperTRK->runSpeed();
+#ifdef SUPPORT_PEC
+  if ((_pecStatus == PEC_RECORDING) && (_stepperRA->motorPosition() - _pecRecordStart >= ((long)PEC_RECORD_CYCLES * CORRECTION_TABLE_SIZE << (CORRECTION_STEP_BITS + raMicrostepBits)))) {
+    finishPECRecording();
   }
+#endif
 
-  if (_mountStatus & STATUS_SLEWING) {
-    _stepperDEC->run();
-    _stepperRA->run();
+  // The current position follows any steps taken, whatever took them.
+  updateCurrentPosition();
+
+  // Drift alignment doesn't move to a target, so it skips the slew bookkeeping.
+  if (isDriftAligning()) {
+    runDriftAlignment();
+    return;
   }
 
-  if (_stepperDEC->isRunning()) {
+  if (_stepperDEC->isRunning() && !(_mountStatus & STATUS_GUIDE_PULSE_DEC)) {
     decStillRunning = true;
   }
 
-  if (_stepperRA->isRunning()) {
+  if (_stepperRA->isRunning() && !(_mountStatus & STATUS_GUIDE_PULSE_RA)) {
     raStillRunning = true;
   }
 
   if (raStillRunning || decStillRunning) {
-    if (!raStillRunning) {
-      _currentRA = _targetRA;
-    }
-    if (!decStillRunning) {
-      _currentDEC = _targetDEC;
-    }
-
     displayStepperPositionThrottled();
   }
   else {
+    // Only a slew to a target that wasn't stopped on the way ends up at the target.
+    bool atTarget = (_mountStatus & STATUS_SLEWING_TO_TARGET) && !(_mountStatus & STATUS_STOPPING);
     _mountStatus &= ~(STATUS_SLEWING | STATUS_SLEWING_TO_TARGET);
 
+    if (_mountStatus & STATUS_STOPPING) {
+      // The motors have come to a stop, so start the job that was waiting for that.
+      _mountStatus &= ~STATUS_STOPPING;
+      if (_mountStatus & STATUS_JOB_MASK) {
+        startSlewingToHome();
+
+        // Even if we're already home, we need to get to the 'at target' code below.
+        _stepperWasRunning = true;
+        return;
+      }
+    }
+
     if (_stepperWasRunning) {
-      // Mount is at Target!
-      _currentRA = _targetRA;
-      _currentDEC = _targetDEC;
+      // Mount is at Target! The steps only get within a step of it, the target itself is exact.
+      if (atTarget) {
+        _currentRA = _targetRA;
+        _currentDEC = _targetDEC;
+        anchorCurrentPosition();
+      }
 
       // If we we're parking, we just reached home. Clear the flag, reset the motors and stop tracking.
       if (isParking()) {
@@ -823,8 +1915,16 @@ void Mount::loop() {
         setHome();
       }
 
-      _currentDECStepperPosition = _stepperDEC->currentPosition();
-      _currentRAStepperPosition = _stepperRA->currentPosition();
+      // If we were finding home, we're there now. Reset the motors and start tracking if asked.
+      if (isFindingHome()) {
+        _mountStatus &= ~STATUS_FINDING_HOME;
+        setHome();
+        if (_mountStatus & STATUS_HOME_TRACKING) {
+          _mountStatus &= ~STATUS_HOME_TRACKING;
+          startSlewing(TRACKING);
+        }
+      }
+
       _totalDECMove = _totalRAMove = 0;
 
       // Make sure we do one last update when the steppers have stopped.
@@ -844,9 +1944,13 @@ void Mount::loop() {
 //
 /////////////////////////////////
 void Mount::setHome() {
+  // Keep HA moving along from where it is, now that the tracked steps start from 0 again.
+  _baseTrackingSteps -= _stepperRA->trackingPosition();
   _stepperRA->setCurrentPosition(0);
   _stepperDEC->setCurrentPosition(0);
-  _stepperTRK->setCurrentPosition(0);
+  _stepperRA->setTrackingPosition(0);
+  _stepperDEC->setTrackingPosition(0);
+  anchorCurrentPosition();
 }
 
 /////////////////////////////////
@@ -856,15 +1960,16 @@ void Mount::setHome() {
 // Set RA and DEC to the home position
 /////////////////////////////////
 void Mount::setTargetToHome() {
-  float trackedSeconds = _stepperTRK->currentPosition() / _trackingSpeed; // steps/steps/s
+  // The RA stepper position does not include tracking, so home is the same
+  // number of steps away from where tracking has moved the mount to.
+  DayTime tracked(_stepperRA->trackingPosition() / stepsPerSiderealHour);
 
   // In order for RA coordinates to work correctly, we need to
-  // offset HATime by elapsed time since last HA set and also
-  // adjust RA by the elapsed time and set it to zero.
-  _targetRA.set(0, 0, 0);
-  _targetRA.addSeconds(trackedSeconds);
+  // offset HATime by how far we tracked since last HA set and also
+  // adjust RA by that and set it to zero.
+  _targetRA = tracked;
   DayTime ha(_HATime);
-  ha.addSeconds(trackedSeconds);
+  ha.addTime(tracked);
   setHA(ha);
 
   // Set DEC to pole
@@ -895,59 +2000,134 @@ float Mount::getSpeed(int direction) {
 //
 // calculateRAandDECSteppers
 //
-// This code tells the steppers to what location to move to, given the select right ascension and declination
+// This code tells the steppers to what location to move to, given the select right ascension and declination.
+// Every target can be reached from both sides of the pier. With PIER_SIDE_AUTO, both are planned and the quickest
+// slew that stays within the limits is picked. Returns false if neither side can reach the target. Unless aligned is
+// false, the target is corrected by the alignment model first.
 /////////////////////////////////
-void Mount::calculateRAandDECSteppers(float& targetRA, float& targetDEC) {
+bool Mount::calculateRAandDECSteppers(float& targetRA, float& targetDEC, byte pierSide, bool aligned) {
   float hourPos = _targetRA.getTotalHours();
+  float decPos = _targetDEC.getTotalDegrees();
+
+#ifdef SUPPORT_ALIGNMENT
+  // Aim the axes where the alignment model says the target is for them.
+  if (aligned && (_alignmentStars != 0)) {
+    applyAlignment(hourPos, decPos);
+  }
+#endif
+
   // Map [0 to 24] range to [-12 to +12] range
   if (hourPos > 12) {
     hourPos = hourPos - 24;
   }
 
-  // How many steps moves the RA ring one sidereal hour along. One sidereal hour moves just shy of 15 degrees
-  float stepsPerSiderealHour = _stepsPerRADegree * siderealDegreesInHour;
-
   // Where do we want to move RA to?
-  float moveRA = hourPos * stepsPerSiderealHour / 2;
+  float moveRA = hourPos * stepsPerSiderealHour;
 
   // Where do we want to move DEC to?
-  // the variable targetDEC 0deg for the celestial pole (90deg), and goes negative only.
-  float moveDEC = -_targetDEC.getTotalDegrees() * _stepsPerDECDegree;
-
-  // We can move 6 hours in either direction. Outside of that we need to flip directions.
-  float RALimit = (6.0f * stepsPerSiderealHour / 2);
-
-  // If we reach the limit in the positive direction ...
-  if (moveRA > RALimit) {
-    // ... turn both RA and DEC axis around
-    float oldRA = moveRA;
-    moveRA -= long(12.0f * stepsPerSiderealHour / 2);
-    moveDEC = -moveDEC;
-  }
-  // If we reach the limit in the negative direction...
-  else if (moveRA < -RALimit) {
-    // ... turn both RA and DEC axis around
-    float oldRA = moveRA;
-    moveRA += long(12.0f * stepsPerSiderealHour / 2);
-    moveDEC = -moveDEC;
-  }
-
-  //    float targetRA = clamp(-moveRA, -RAStepperLimit, RAStepperLimit);
-  //    float targetDEC = clamp(moveDEC, DECStepperUpLimit, DECStepperDownLimit);
-  targetRA = -moveRA;
-  targetDEC = moveDEC;
-
-  // Can we get there without physical issues? (not doing anything with this yet)
-  //  isUnreachable = ((targetRA != -moveRA) || (targetDEC != moveDEC));
-
-  //  if (stepperRA.currentPosition() != int(targetRA)) {
-  //    Serial.println("Moving RA from " + String(stepperRA.currentPosition()) + " to " + targetRA);
-  //  }
-  //  if (stepperDEC.currentPosition() != (targetDEC)) {
-  //    Serial.println("Moving DEC from " + String(stepperDEC.currentPosition()) + " to " + targetDEC);
-  //  }
+  // decPos is 0deg for the celestial pole (90deg), and goes negative only.
+  float moveDEC = -decPos * stepsPerDECDegree;
+
+  // The other side of the pier turns RA half a turn back towards home and DEC past the pole.
+  float flippedRA = moveRA + ((moveRA > 0) ? -long(12.0f * stepsPerSiderealHour) : long(12.0f * stepsPerSiderealHour));
+
+  // The RA stepper runs the opposite way.
+  float eastRA = -moveRA;
+  float westRA = -flippedRA;
+  float eastDEC = moveDEC;
+  float westDEC = -moveDEC;
+
+  if (pierSide == PIER_SIDE_AUTO) {
+    bool eastOk = canReach(eastRA, eastDEC);
+    bool westOk = canReach(westRA, westDEC);
+    if (eastOk && westOk) {
+      pierSide = (slewDurationTo(westRA, westDEC) < slewDurationTo(eastRA, eastDEC)) ? PIER_SIDE_WEST : PIER_SIDE_EAST;
+    }
+    else if (eastOk || westOk) {
+      pierSide = eastOk ? PIER_SIDE_EAST : PIER_SIDE_WEST;
+    }
+    else {
+      // Fall back to the side that keeps RA closest to home.
+      pierSide = (fabs(moveRA) > fabs(flippedRA)) ? PIER_SIDE_WEST : PIER_SIDE_EAST;
+    }
+  }
+
+  targetRA = (pierSide == PIER_SIDE_WEST) ? westRA : eastRA;
+  targetDEC = (pierSide == PIER_SIDE_WEST) ? westDEC : eastDEC;
+
+  return canReach(targetRA, targetDEC);
+}
+
+/////////////////////////////////
+//
+// canReach
+//
+// Returns true if the steppers can move to the given positions. The RA ring can turn 6 hours (plus the
+// meridian hysteresis) either way from home, and both axes have to stay within their limits.
+/////////////////////////////////
+bool Mount::canReach(float targetRA, float targetDEC) const {
+  // Tracking has turned the RA ring as well.
+  float ringRA = targetRA + _stepperRA->trackingPosition();
+  if (fabs(ringRA) > meridianFlipSteps) {
+    return false;
+  }
+
+  return (_stepperRA->clampToLimits((long)targetRA) == (long)targetRA) && (_stepperDEC->clampToLimits((long)targetDEC) == (long)targetDEC);
+}
+
+/////////////////////////////////
+//
+// slewDurationTo
+//
+// How long (in seconds) a slew from where the steppers are to the given positions takes.
+/////////////////////////////////
+float Mount::slewDurationTo(float targetRA, float targetDEC) {
+  resetSlewSpeeds();
+  float raDuration = _stepperRA->moveDuration((long)targetRA - _stepperRA->currentPosition());
+  float decDuration = _stepperDEC->moveDuration((long)targetDEC - _stepperDEC->currentPosition());
+  return max(raDuration, decDuration);
+}
+
+/////////////////////////////////
+//
+// resetSlewSpeeds
+//
+// Run both steppers at their full speed and acceleration again.
+/////////////////////////////////
+void Mount::resetSlewSpeeds() {
+  _stepperRA->setMaxSpeed(raMaxSpeed);
+  _stepperRA->setAcceleration(raAcceleration);
+  _stepperDEC->setMaxSpeed(decMaxSpeed);
+  _stepperDEC->setAcceleration(decAcceleration);
 }
+
+/////////////////////////////////
+//
+// moveSteppersTo
+//
+/////////////////////////////////
 void Mount::moveSteppersTo(float targetRA, float targetDEC) {
+  resetSlewSpeeds();
+
+  // How long would each axis take at full speed?
+  float raDuration = _stepperRA->moveDuration((long)targetRA - _stepperRA->currentPosition());
+  float decDuration = _stepperDEC->moveDuration((long)targetDEC - _stepperDEC->currentPosition());
+  _slewDuration = max(raDuration, decDuration);
+  _slewStartTime = millis();
+
+  // Slow the quicker axis down so that it takes as long as the slower one. Running the whole
+  // profile slower by a factor k scales the speed by k and the acceleration by k squared.
+  if ((raDuration > 0) && (raDuration < _slewDuration)) {
+    float k = raDuration / _slewDuration;
+    _stepperRA->setMaxSpeed(k * raMaxSpeed);
+    _stepperRA->setAcceleration(k * k * raAcceleration);
+  }
+  else if ((decDuration > 0) && (decDuration < _slewDuration)) {
+    float k = decDuration / _slewDuration;
+    _stepperDEC->setMaxSpeed(k * decMaxSpeed);
+    _stepperDEC->setAcceleration(k * k * decAcceleration);
+  }
+
   // Show time: tell the steppers where to go!
   _stepperRA->moveTo(targetRA);
   _stepperDEC->moveTo(targetDEC);
@@ -1050,7 +2230,16 @@ String Mount::DECString(byte type, byte active) {
   }
   dec.checkHours();
 
-  sprintf(scratchBuffer, formatStringsDEC[type & FORMAT_STRING_MASK], dec.getPrintDegrees() > 0 ? '+' : '-', int(fabs(dec.getPrintDegrees())), dec.getMinutes(), dec.getSeconds());
+  // Split the sign off first, so that the minutes and seconds of a negative DEC count away from 0 as well.
+  long units = dec.getTotalUnits() + (NORTHERN_HEMISPHERE ? 90L : -90L) * TIME_UNITS_PER_HOUR;
+  char sign = (units < 0) ? '-' : '+';
+  units = labs(units);
+  int degrees = units / TIME_UNITS_PER_HOUR;
+  int minutes = units / TIME_UNITS_PER_MINUTE % 60;
+  int seconds = units / TIME_UNITS_PER_SECOND % 60;
+  int tenths = units % TIME_UNITS_PER_SECOND / (TIME_UNITS_PER_SECOND / 10);
+
+  sprintf(scratchBuffer, formatStringsDEC[type & FORMAT_STRING_MASK], sign, degrees, minutes, seconds, tenths);
   if ((type & FORMAT_STRING_MASK) == LCDMENU_STRING) {
     scratchBuffer[active * 4 + (active > 0 ? 1 : 0)] = '>';
   }
@@ -1076,7 +2265,8 @@ String Mount::RAString(byte type, byte active) {
   DayTime raDisplay(ra);
   raDisplay.addTime(_HACorrection);
 
-  sprintf(scratchBuffer, formatStringsRA[type & FORMAT_STRING_MASK], raDisplay.getHours(), raDisplay.getMinutes(), raDisplay.getSeconds());
+  int tenths = raDisplay.getTotalUnits() % TIME_UNITS_PER_SECOND / (TIME_UNITS_PER_SECOND / 10);
+  sprintf(scratchBuffer, formatStringsRA[type & FORMAT_STRING_MASK], raDisplay.getHours(), raDisplay.getMinutes(), raDisplay.getSeconds(), tenths);
   if ((type & FORMAT_STRING_MASK) == LCDMENU_STRING) {
     scratchBuffer[active * 4] = '>';
   }
@@ -2,10 +2,11 @@
 #define _MOUNT_HPP_
 
 #include <LiquidCrystal.h>
-#include <AccelStepper.h>
 #include "Globals.h"
+#include "InterruptStepper.hpp"
 #include "DayTime.hpp"
 #include "LcdMenu.hpp"
+#include "Precession.hpp"
 
 #define NORTH                      B00000001
 #define EAST                       B00000010
@@ -19,13 +20,52 @@
 #define PRINT_STRING        B0011
 #define LCD_STRING          B0100
 #define COMPACT_STRING      B0101
+#define MEADE_PRECISE_STRING B0110
 #define FORMAT_STRING_MASK  B0111
 
 #define TARGET_STRING      B01000
 #define CURRENT_STRING     B10000
 
-#define HALFSTEP 8
-#define FULLSTEP 4
+// PEC states, see pecStatus()
+#define PEC_OFF                    0
+#define PEC_RECORDING              1
+#define PEC_PLAYING                2
+
+// Tracking rates, see setTrackingRateMode(). The numbers are the same as the ASCOM DriveRates.
+#define TRACKING_SIDEREAL          0
+#define TRACKING_LUNAR             1
+#define TRACKING_SOLAR             2
+#define TRACKING_KING              3
+#define TRACKING_CUSTOM            4
+
+#ifdef SUPPORT_KING_RATE
+// How often (in ms) the King rate is worked out again for where the mount points, and over how many
+// hours of hour angle the change in refraction is measured.
+#define KING_RATE_INTERVAL         5000
+#define KING_RATE_SPAN             0.25f
+#endif
+
+#ifdef SUPPORT_ALIGNMENT
+// How many alignment stars the pointing model is solved from, see addAlignmentStar()
+#define ALIGNMENT_STARS            3
+#endif
+
+// Guide rates are set in tenths of the sidereal rate, see setGuideRate()
+#define MIN_GUIDE_RATE             1
+#define MAX_GUIDE_RATE             10
+
+// Sides of the pier, see pierSide(). East is the normal pointing state, west is with DEC turned past the pole.
+#define PIER_SIDE_EAST             0
+#define PIER_SIDE_WEST             1
+#define PIER_SIDE_AUTO             2
+
+// Phases of the drift alignment run, see driftAlignmentPhase()
+#define DRIFT_PAUSE_START          0
+#define DRIFT_EAST                 1
+#define DRIFT_PAUSE_MIDDLE         2
+#define DRIFT_WEST                 3
+#define DRIFT_PAUSE_END            4
+#define DRIFT_RETURNING            5
 
 //////////////////////////////////////////////////////////////////
 //
@@ -34,46 +74,140 @@
 //////////////////////////////////////////////////////////////////
 class Mount {
 public:
-  Mount(int stepsPerRAHour, int stepsPerDECDegree, LcdMenu* lcdMenu);
+  // The steps per degree and the slew speeds are fixed when the firmware is built, see MountGeometry.hpp.
+  Mount(LcdMenu* lcdMenu);
 
-  // Configure the RA stepper motor. This also sets up the TRK stepper on the same pins.
-  void configureRAStepper(byte stepMode, byte pin1, byte pin2, byte pin3, byte pin4, int maxSpeed, int maxAcceleration);
+  // Configure the RA stepper motor. The same stepper slews and tracks. The sketch creates the stepper with its driver.
+  void configureRAStepper(InterruptStepper* stepper);
 
   // Configure the DEC stepper motor.
-  void configureDECStepper(byte stepMode, byte pin1, byte pin2, byte pin3, byte pin4, int maxSpeed, int maxAcceleration);
+  void configureDECStepper(InterruptStepper* stepper);
 
-  // Set the HA time
+  // Set the HA time. From then on HA moves along with the sidereal time, less what tracking has followed,
+  // so that it stays right even when the mount does not track (or tracks at another rate).
   void setHA(const DayTime& haTime);
   const DayTime& HA() const;
   void setHACorrection(int h, int m, int s);
   DayTime getHACorrection();
 
+  // Set the local date, the local time, the hours to add to the local time to get UTC and the longitude of
+  // the site in degrees (east is positive). Once both the date and the time have been set, HA is set from
+  // the local sidereal time they give, so it does not need to be entered.
+  void setLocalDate(int year, int month, int day);
+  void getLocalDate(int& year, int& month, int& day) const;
+  void setLocalTime(const DayTime& localTime);
+  DayTime localTime() const;
+  void setUTCOffset(float hours);
+  float getUTCOffset() const;
+  void setLongitude(float degrees);
+  float getLongitude() const;
+
+  // Get the local sidereal time, which is the RA on the meridian.
+  DayTime localSiderealTime() const;
+
+  // Move the given J2000 RA (hours) and DEC (degrees) to where they are on the local date (or the date the
+  // firmware was built, if it has not been set), with precession, nutation and aberration.
+  void precessToDate(float& raHours, float& decDegrees) const;
+
+  // Set the target to the given J2000 RA (hours) and DEC (degrees), moved to the local date.
+  void setTargetJ2000(float raHours, float decDegrees);
+
   // Get a reference to the target RA value.
   DayTime& targetRA();
 
   // Get a reference to the target DEC value.
   DegreeTime& targetDEC();
 
-  // Get current RA value.
+  // Get current RA value. This is kept up to date by loop() as the steppers move, so it is only a read.
   const DayTime currentRA() const;
 
-  // Get current DEC value.
+  // Get current DEC value. This is kept up to date by loop() as the steppers move, so it is only a read.
   const DegreeTime currentDEC() const;
 
   // Set the current RA position to be the given time
-  void syncRA(int hour, int minute, int second);
+  void syncRA(const DayTime& ra);
 
   // Set the current DEC position to be the given degrees
-  void syncDEC(int degree, int minute, int second);
+  void syncDEC(const DegreeTime& dec);
+
+#ifdef SUPPORT_ALIGNMENT
+  // Add the target as an alignment star, after the mount has been centered on it. The first star syncs RA to it.
+  // From the second star on, every slew is corrected with a model of how the axes are off (like polar misalignment
+  // and cone error), which is solved from the last ALIGNMENT_STARS stars. Syncing starts over.
+  void addAlignmentStar();
+
+  // Stop correcting slews and forget the alignment stars.
+  void clearAlignment();
+
+  // Get the number of alignment stars the model was solved from (0 if there is no model).
+  byte alignmentStars() const;
+
+  // Get how the alignment model says the mount is off, in arcminutes. The celestial pole is poleUp from the RA axis
+  // towards HA 0h (up, in the northern hemisphere) and poleWest towards HA 6h. Skew is how far the model's axes are
+  // from square, which is how much the stars disagree with the mount being just turned. All are 0 without a model.
+  void getAlignmentErrors(float& poleUp, float& poleWest, float& skew) const;
+#endif
+
+  // Set the number of steps of slack in the gears of the RA (EAST or WEST) or DEC (NORTH or SOUTH) axis.
+  // The steppers take these up automatically whenever they reverse. Like the limits and the drift alignment
+  // steps, these are (half) steps of the 28BYJ-48, or full steps of a step/dir driver, without microsteps.
+  void setBacklash(int direction, int steps);
+  int getBacklash(int direction);
+
+  // Keep the RA (EAST or WEST) or DEC (NORTH or SOUTH) axis between the given stepper positions, to prevent
+  // physical damage. Zero is the home position. All motion decelerates or stops at the limits.
+  void setLimits(int direction, long low, long high);
+
+  // Returns the directions (WEST, EAST, NORTH, SOUTH) in which the axes are at their limits, or 0.
+  int atLimit() const;
+
+  // Returns PIER_SIDE_EAST or PIER_SIDE_WEST, depending on which way DEC is turned.
+  byte pierSide() const;
+
+  // Returns true if the last target that was slewed to is outside the limits. The mount did not move then.
+  bool isUnreachable() const;
+
+  // Set the guide rate of the RA (EAST or WEST) or DEC (NORTH or SOUTH) axis in tenths of the sidereal rate,
+  // from MIN_GUIDE_RATE (0.1x) to MAX_GUIDE_RATE (1.0x).
+  void setGuideRate(int direction, byte tenths);
+  byte getGuideRate(int direction);
 
   float getSpeedCalibration();
 
   void setSpeedCalibration(float val);
 
+  // Track at the sidereal, lunar, solar, King or custom rate (TRACKING_SIDEREAL, _LUNAR, _SOLAR, _KING or _CUSTOM).
+  // The calibration applies to all of them. The King rate follows the stars as refraction shows them, which
+  // lifts them more the lower they are. Both RA and DEC track then, at rates that are updated every
+  // KING_RATE_INTERVAL ms for the position of the mount and the latitude. It needs SUPPORT_KING_RATE.
+  void setTrackingRateMode(byte mode);
+  byte getTrackingRateMode() const;
+
+#ifdef SUPPORT_KING_RATE
+  // Set the latitude of the site in degrees (negative is south). Only the King rate uses it.
+  void setLatitude(float degrees);
+  float getLatitude() const;
+#endif
+
+  // Set the custom tracking rate, as a fraction of the sidereal rate.
+  void setCustomTrackingRate(float siderealFraction);
+
+  // Get the current tracking rate, as a fraction of the sidereal rate.
+  float getTrackingRateFactor() const;
+
   // Calculates movement parameters and program steppers to move
   // there. Must call loop() frequently to actually move.
   void startSlewingToTarget();
 
+  // Slew to the home position. Home is where the steppers were zeroed, so the alignment model does not apply.
+  void startSlewingToHome();
+
+  // Get how long (in seconds) the last slew to target was planned to take.
+  float slewDuration() const;
+
+  // Get how long (in seconds) the current slew to target still takes, or 0 if it should have arrived.
+  float slewTimeRemaining() const;
+
   bool isSlewingDEC() const;
   bool isSlewingRA() const;
   bool isSlewingRAorDEC() const;
@@ -81,6 +215,10 @@ public:
   bool isSlewingTRK() const;
   bool isParked() const;
   bool isParking() const;
+  bool isFindingHome() const;
+
+  // Returns true while the motors are decelerating after a stop. Parking and finding home wait for this.
+  bool isStopping() const;
   bool isGuiding() const;
 
   // Starts manual slewing in one of eight directions or tracking
@@ -98,26 +236,30 @@ public:
   // Gets the position in one of eight directions or tracking
   long getCurrentStepperPosition(int direction);
 
-  // Process any stepper movement. Must be called frequently
+  // Process any stepper state changes. Must be called frequently. The motors themselves are
+  // stepped from the timer interrupt.
   void loop();
 
   // Set RA and DEC to the home position
   void setTargetToHome();
 
-  // Synchronously slews the mount to the home position and sets tracking to argument.
+  // Asynchronously slews the mount to the home position and sets tracking to argument once there.
+  // isFindingHome() is true until it gets there.
   void goHome(bool tracking);
 
   // Set the current stepper positions to be home.
   void setHome();
 
-  // Asynchronously parks the mount. Moves to the home position and stops all motors. 
+  // Asynchronously parks the mount. Moves to the home position and stops all motors.
+  // isParking() is true until it gets there.
   void park();
 
-  // Runs the RA motor at twice the speed (or stops it), or the DEC motor at tracking speed for the given duration in ms.
+  // Moves RA or DEC at the guide rate for the given duration in ms. RA guides on top of tracking.
+  // RA and DEC pulses are independent and can overlap. Ignored while slewing.
   void guidePulse(byte direction, int duration);
 
-  // Stops any guide operation in progress.
-  void stopGuiding();
+  // Stops the guide pulses in progress on the given axes.
+  void stopGuiding(bool ra = true, bool dec = true);
 
   // Return a string of DEC in the given format. For LCDSTRING, active determines where the cursor is
   String DECString(byte type, byte active = 0);
@@ -133,19 +275,114 @@ public:
 
   void displayStepperPositionThrottled();
 
-  void runDriftAlignmentPhase(int direction, int durationSecs);
+  // Asynchronously runs a drift alignment. After a pause, RA is moved the given number of steps east
+  // in the given duration (in seconds), and after another pause back west in the same duration. Tracking
+  // is off while it runs and turned back on at the end. loop() runs the phases.
+  void startDriftAlignment(int durationSecs, long steps);
+
+  // Cancels the drift alignment. RA moves back to where it started and, if asked, tracking is turned back on.
+  void stopDriftAlignment(bool resumeTracking);
+
+  bool isDriftAligning() const;
+
+  // Get the current phase of the drift alignment (DRIFT_PAUSE_START, DRIFT_EAST, etc.)
+  byte driftAlignmentPhase() const;
+
+#ifdef SUPPORT_PEC
+  // Start recording the periodic error. RA guide pulses are collected by RA motor position for
+  // PEC_RECORD_CYCLES turns of the motor, then the average is stored in EEPROM and played back.
+  void startPECRecording();
+
+  // Play back the recorded periodic error correction, if there is one.
+  void startPECPlayback();
+
+  // Stop recording or playing back.
+  void stopPEC();
+
+  // Load the periodic error correction from EEPROM and play it back, if there is one.
+  void loadPEC();
+
+  // Returns PEC_OFF, PEC_RECORDING or PEC_PLAYING
+  byte pecStatus() const;
+#endif
 
 private:
-  void calculateRAandDECSteppers(float& targetRA, float& targetDEC);
+  // Moves the sidereal clock along to now.
+  void updateSiderealClock();
+
+  // Moves HA along by the sidereal time that passed since it was set, less the steps tracking has taken since.
+  void updateSiderealTime();
+
+  // Sets HA from the local sidereal time of the local date and time and the longitude, if both are known.
+  void setHAFromLocalTime();
+
+  void applyHA(const DayTime& haTime);
+
+  // The RA steps that tracking takes in one sidereal hour, with the speed calibration.
+  float calibratedStepsPerSiderealHour() const;
+
+  uint32_t trackingRateE6() const;
+  void updateTrackingRate();
+
+#ifdef SUPPORT_KING_RATE
+  // Works out the King rates of both axes for where the mount points now.
+  void updateKingRate();
+#endif
+
+  // Starts the slew to the target, corrected by the alignment model if aligned is true.
+  void slewToTarget(bool aligned);
+  bool calculateRAandDECSteppers(float& targetRA, float& targetDEC, byte pierSide, bool aligned = true);
+  bool canReach(float targetRA, float targetDEC) const;
+  float slewDurationTo(float targetRA, float targetDEC);
+  void resetSlewSpeeds();
   void displayStepperPosition();
+
+  // Moves the drift alignment along to its next phase once the current one is done.
+  void runDriftAlignment();
+
+#ifdef SUPPORT_PEC
+  // Adds a guide correction (in eighths of a step) to the PEC recording at the current RA motor position.
+  void recordPECCorrection(long eighths);
+
+  // Averages the recorded corrections into the PEC table, stores it and starts playing it back.
+  void finishPECRecording();
+#endif
+
+#ifdef SUPPORT_ALIGNMENT
+  // Solves the alignment model from the alignment stars.
+  void solveAlignment();
+
+  // Moves the given RA (hours) and DEC (degrees, 0 at the pole) to where the axes need to be to point there.
+  void applyAlignment(float& hourPos, float& decPos) const;
+
+  // Convert between RA (hours) and DEC (degrees, 0 at the pole) and a unit vector of the hour angle and declination.
+  void toAlignmentVector(float hourPos, float decPos, float v[3]) const;
+  void fromAlignmentVector(const float v[3], float& hourPos, float& decPos) const;
+#endif
+
+  // Moves RA and DEC to the given positions so that they both arrive at the same time.
   void moveSteppersTo(float targetRA, float targetDEC);
 
+  // Returns true if the DEC axis is past the pole, so that RA is 12h off.
+  bool isDECFlipped() const;
+
+  // Convert stepper positions to RA hours (without the flip) and DEC degrees.
+  float stepperRAHours(long position) const;
+  float stepperDECDegrees(long position) const;
+
+  // Take the current RA and DEC to be where the steppers are now. From then on they follow the steppers.
+  void anchorCurrentPosition();
+
+  // Move the current RA and DEC along with the steppers, if they have taken any steps since the last time.
+  void updateCurrentPosition();
+
   // Returns NOT_SLEWING, SLEWING_DEC, SLEWING_RA, or SLEWING_BOTH. SLEWING_TRACKING is an overlaid bit.
   byte slewStatus() const;
 
   // What is the state of the mount. 
-  // Returns some combination of these flags: STATUS_PARKED, STATUS_SLEWING, STATUS_SLEWING_TO_TARGET, STATUS_SLEWING_FREE, STATUS_TRACKING, STATUS_PARKING
-  byte mountStatus();
+  // Returns some combination of these flags: STATUS_PARKED, STATUS_SLEWING, STATUS_SLEWING_TO_TARGET, STATUS_SLEWING_FREE, STATUS_TRACKING, STATUS_PARKING,
+  // STATUS_STOPPING, STATUS_FINDING_HOME, STATUS_HOME_TRACKING and the STATUS_GUIDE_PULSE flags
+  int mountStatus();
 
 #ifdef DEBUG_MODE
   String mountStatusString();
@@ -154,40 +391,107 @@ private:
 
 private:
   LcdMenu* _lcdMenu;
-  int  _stepsPerRADegree;
-  int _stepsPerDECDegree;
-  int _maxRASpeed;
-  int _maxDECSpeed;
-  int _maxRAAcceleration;
-  int _maxDECAcceleration;
 
   long _lastHASet;
   DayTime _HAAdjust;
 
-  DayTime _targetRA;
-  DayTime _currentRA;
-  long _currentRAStepperPosition;
+  // The sidereal time since the mount started, and HA, that time and the tracked RA steps when HA was set.
+  DayTime _siderealClock;
+  unsigned long _siderealClockMicros;
+  unsigned long _lastSiderealUpdate;
+  DayTime _baseHA;
+  DayTime _baseSiderealClock;
+  long _baseTrackingSteps;
+
+  // The local date and time (at millis() _localTimeMillis), as set with setLocalDate() and setLocalTime().
+  int _localYear;
+  byte _localMonth;
+  byte _localDay;
+  DayTime _localTime;
+  unsigned long _localTimeMillis;
+  bool _hasLocalDate;
+  bool _hasLocalTime;
+  float _utcOffset;
+  float _longitude;
+
+  // Moves J2000 coordinates to the local date.
+  Precession _precession;
+
+#ifdef SUPPORT_ALIGNMENT
+  // The alignment stars, as where they are (sky) and where the axes pointed (mount), in hour angle and declination
+  // vectors. _alignment turns a sky vector into a mount vector.
+  float _alignmentSky[ALIGNMENT_STARS][3];
+  float _alignmentMount[ALIGNMENT_STARS][3];
+  byte _alignmentCount;
+  byte _nextAlignmentStar;
+  byte _alignmentStars;
+  float _alignment[3][3];
+#endif
 
+  DayTime _targetRA;
   DegreeTime _targetDEC;
+
+  // The current position, and the stepper positions it was worked out for. It is worked out again from the
+  // anchor (where the mount was known to point, and the stepper positions and side of the pier then) and the
+  // steps taken since, so rounding never adds up.
+  DayTime _currentRA;
   DegreeTime _currentDEC;
-  long _currentDECStepperPosition;
+  long _currentRASteps;
+  long _currentDECSteps;
+  DayTime _anchorRA;
+  DegreeTime _anchorDEC;
+  long _anchorRASteps;
+  long _anchorDECSteps;
+  bool _anchorFlipped;
 
   float _totalDECMove;
   float _totalRAMove;
+  unsigned long _slewStartTime;
+  float _slewDuration;
+
+  byte _driftPhase;
+  unsigned long _driftPhaseStart;
+  int _driftDuration;
+  long _driftSteps;
+  long _driftStartPosition;
+
+#ifdef SUPPORT_PEC
+  int8_t _pecTable[CORRECTION_TABLE_SIZE];
+  int* _pecSums;
+  byte _pecStatus;
+  bool _pecValid;
+  long _pecRecordStart;
+#endif
 
-  // Stepper control for RA, DEC and TRK.
-  AccelStepper* _stepperRA;
-  AccelStepper* _stepperDEC;
-  AccelStepper* _stepperTRK;
+  // Stepper control for RA and DEC. The RA stepper also tracks.
+  InterruptStepper* _stepperRA;
+  InterruptStepper* _stepperDEC;
 
-  unsigned long _guideEndTime;
+  byte _guideRateRA;
+  byte _guideRateDEC;
+  unsigned long _guideStartTimeRA;
+  unsigned long _guideDurationRA;
+  unsigned long _guideStartTimeDEC;
+  unsigned long _guideDurationDEC;
   unsigned long _lastMountPrint = 0;
   DayTime _HATime;
   DayTime _HACorrection;
   float _trackingSpeed;
+  uint32_t _trackingRate;
+  uint32_t _siderealRate;
+  byte _trackingRateMode;
+  uint32_t _customTrackingRateE6;
+#ifdef SUPPORT_KING_RATE
+  float _latitude;
+  uint32_t _kingRateE6;
+  uint32_t _kingRateDEC;
+  int8_t _kingDirectionDEC;
+  unsigned long _lastKingUpdate;
+#endif
   float _trackingSpeedCalibration;
   unsigned long _lastDisplayUpdate;
-  byte _mountStatus;
+  int _mountStatus;
+  bool _isUnreachable;
   char scratchBuffer[24];
   bool _stepperWasRunning;
 };
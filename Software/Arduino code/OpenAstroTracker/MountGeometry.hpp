@@ -0,0 +1,80 @@
+#ifndef _MOUNTGEOMETRY_HPP_
+#define _MOUNTGEOMETRY_HPP_
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "StepperDrivers.hpp"
+
+#ifndef RA_RING_VERSION
+#error "Please uncomment the RA_RING_VERSION line in Globals.h that matches the version of the RA ring you printed."
+#endif
+
+//////////////////////////////////////////////////////////////////
+//
+// The geometry of the mount, as set up in Globals.h. None of it changes while the firmware runs, so
+// it is all constant expressions. That way the compiler works out everything that follows from it
+// (the steps per sidereal hour, the flip limit, the ratio of DEC to RA steps for guiding) once,
+// instead of the Arduino doing it in floats for every slew and guide pulse.
+//
+//////////////////////////////////////////////////////////////////
+
+// The steps per degree of each version of the RA ring, in halfsteps of the 28BYJ-48.
+// The radius of the surface that the belt runs on (in V1 of the ring) was 168.24mm.
+// Belt moves 40mm for one stepper revolution (2mm pitch, 20 teeth).
+// RA wheel is 2 x PI x 168.24mm (V2:180mm) circumference = 1057.1mm (V2:1131mm)
+// One RA revolution needs 26.43 (1057.1mm / 40mm) stepper revolutions (V2: 28.27 (1131mm/40mm))
+// Which means 108245 steps (26.43 x 4096) moves 360 degrees (V2: 115812 steps (28.27 x 4096))
+// So there are 300.1 steps/degree (108245 / 360)  (V2: 322 (115812 / 360))
+// Theoretically correct RA tracking speed is 1.246586 (300 x 14.95903 / 3600) (V2 : 1.333800 (322 x 14.95903 / 3600) steps/sec
+template <int Version>
+struct RARing;
+
+// V1 Ring has a ridge on top of the ring that the belt runs on and the ring runs on the bearings
+template <>
+struct RARing<1> {
+  static constexpr int STEPS_PER_DEGREE = 300;
+};
+
+// V2 Ring has belt in a groove and belt runs on bearings
+template <>
+struct RARing<2> {
+  static constexpr int STEPS_PER_DEGREE = 322;
+};
+
+// For step/dir drivers the steps per degree are full steps, each of which the driver splits into microsteps.
+constexpr int raStepFactor = (RA_DRIVER == DRIVER_STEPDIR) ? RA_MICROSTEPS : 1;
+constexpr int decStepFactor = (DEC_DRIVER == DRIVER_STEPDIR) ? DEC_MICROSTEPS : 1;
+static_assert((raStepFactor & (raStepFactor - 1)) == 0, "RA_MICROSTEPS must be a power of two");
+
+// How many bits of the RA motor position are microsteps. The periodic error correction is indexed by full steps.
+constexpr byte bitsInStepFactor(int factor) { return (factor > 1) ? 1 + bitsInStepFactor(factor >> 1) : 0; }
+constexpr byte raMicrostepBits = bitsInStepFactor(raStepFactor);
+
+// The motor steps that turn each axis one degree.
+constexpr long stepsPerRADegree = (long)RARing<RA_RING_VERSION>::STEPS_PER_DEGREE * raStepFactor;
+constexpr long stepsPerDECDegree = (long)DEC_STEPS_PER_DEGREE * decStepFactor;
+
+// How many degrees the sky turns in an hour.
+constexpr float siderealDegreesInHour = 14.95902778f;
+
+// The same, scaled by 10^7 and rounded, for the integer tracking rate calculation. The whole and fractional
+// degrees are scaled separately, since a float can't hold the scaled value to the nearest unit.
+constexpr uint32_t siderealDegreesInHourE7 = (uint32_t)siderealDegreesInHour * 10000000UL
+    + (uint32_t)((siderealDegreesInHour - (uint32_t)siderealDegreesInHour) * 10000000.0f + 0.5f);
+
+// How many steps moves the RA ring one sidereal hour along. One sidereal hour moves just shy of 15 degrees.
+constexpr float stepsPerSiderealHour = stepsPerRADegree * siderealDegreesInHour;
+
+// How many DEC steps move the same angle as one RA step. Guiding and the King rate move DEC at the sidereal rate.
+constexpr float decStepsPerRAStep = (float)stepsPerDECDegree / stepsPerRADegree;
+
+// How far (in steps) the RA ring can turn either way from home before a slew has to flip to the other side of the pier.
+constexpr float meridianFlipSteps = (6.0f + MERIDIAN_FLIP_HYSTERESIS) * stepsPerSiderealHour;
+
+// The speeds (steps/s) and accelerations (steps/s/s) of slews.
+constexpr int raMaxSpeed = RA_MAX_SPEED;
+constexpr int raAcceleration = RA_ACCELERATION;
+constexpr int decMaxSpeed = DEC_MAX_SPEED;
+constexpr int decAcceleration = DEC_ACCELERATION;
+
+#endif
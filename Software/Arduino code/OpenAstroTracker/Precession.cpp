@@ -0,0 +1,142 @@
+#include "Utility.h"
+#include "Precession.hpp"
+
+// Radians in a second of arc.
+#define ARCSEC_TO_RAD 4.8481368e-6f
+
+/////////////////////////////////
+//
+// CTOR
+//
+/////////////////////////////////
+Precession::Precession() {
+  // __DATE__ is like "Apr 21 2020"
+  static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  const char* build = __DATE__;
+  int month = 1;
+  for (int i = 0; i < 12; i++) {
+    if (strncmp(build, months + i * 3, 3) == 0) {
+      month = i + 1;
+    }
+  }
+
+#ifdef SUPPORT_PRECESSION
+  _days = -1;
+#endif
+  setDate(atoi(build + 7), month, atoi(build + 4));
+}
+
+#ifdef SUPPORT_PRECESSION
+
+/////////////////////////////////
+//
+// setDate
+//
+/////////////////////////////////
+void Precession::setDate(int year, int month, int day) {
+  long days = daysSinceJ2000(year, month, day);
+  if (days == _days) {
+    return;
+  }
+  _days = days;
+
+  // Julian centuries since J2000
+  float t = days / 36525.0f;
+
+  // Precession angles (IAU 1976). The matrix turns J2000 into mean coordinates of the date.
+  float zeta = (2306.2181f + (0.30188f + 0.017998f * t) * t) * t * ARCSEC_TO_RAD;
+  float z = (2306.2181f + (1.09468f + 0.018203f * t) * t) * t * ARCSEC_TO_RAD;
+  float theta = (2004.3109f - (0.42665f + 0.041833f * t) * t) * t * ARCSEC_TO_RAD;
+  float cosZeta = cos(zeta), sinZeta = sin(zeta);
+  float cosZ = cos(z), sinZ = sin(z);
+  float cosTheta = cos(theta), sinTheta = sin(theta);
+  float p[3][3] = {
+    { cosZeta * cosTheta * cosZ - sinZeta * sinZ, -sinZeta * cosTheta * cosZ - cosZeta * sinZ, -sinTheta * cosZ },
+    { cosZeta * cosTheta * sinZ + sinZeta * cosZ, -sinZeta * cosTheta * sinZ + cosZeta * cosZ, -sinTheta * sinZ },
+    { cosZeta * sinTheta, -sinZeta * sinTheta, cosTheta }
+  };
+
+  // Nutation, from the four largest terms. The mean longitudes of the Sun and the Moon and of the Moon's node.
+  float sunLongitude = (280.4665f + 36000.7698f * t) * DEG_TO_RAD;
+  float moonLongitude = (218.3165f + 481267.8813f * t) * DEG_TO_RAD;
+  float node = (125.04452f - 1934.136261f * t) * DEG_TO_RAD;
+  float dPsi = (-17.20f * sin(node) - 1.32f * sin(2 * sunLongitude) - 0.23f * sin(2 * moonLongitude) + 0.21f * sin(2 * node)) * ARCSEC_TO_RAD;
+  float dEps = (9.20f * cos(node) + 0.57f * cos(2 * sunLongitude) + 0.10f * cos(2 * moonLongitude) - 0.09f * cos(2 * node)) * ARCSEC_TO_RAD;
+  float obliquity = (84381.448f - 46.815f * t) * ARCSEC_TO_RAD;
+  float cosEps = cos(obliquity), sinEps = sin(obliquity);
+
+  // The angles are tens of arcseconds, so the nutation matrix only needs the first order terms.
+  float n[3][3] = {
+    { 1.0f, -dPsi * cosEps, -dPsi * sinEps },
+    { dPsi * cosEps, 1.0f, -dEps },
+    { dPsi * sinEps, dEps, 1.0f }
+  };
+
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      _matrix[i][j] = n[i][0] * p[0][j] + n[i][1] * p[1][j] + n[i][2] * p[2][j];
+    }
+  }
+
+  // Annual aberration shifts the stars up to 20.5" towards where the Earth is heading, which is 90 degrees
+  // behind the Sun along the ecliptic. Adding this to the unit vector and normalising does the same.
+  float anomaly = (357.529f + 35999.050f * t) * DEG_TO_RAD;
+  float sunTrue = sunLongitude + (1.915f * sin(anomaly) + 0.020f * sin(2 * anomaly)) * DEG_TO_RAD;
+  float kappa = 20.49552f * ARCSEC_TO_RAD;
+  _aberration[0] = kappa * sin(sunTrue);
+  _aberration[1] = -kappa * cos(sunTrue) * cosEps;
+  _aberration[2] = -kappa * cos(sunTrue) * sinEps;
+}
+
+/////////////////////////////////
+//
+// toDate
+//
+/////////////////////////////////
+void Precession::toDate(float& raHours, float& decDegrees) const {
+  float ra = raHours * 15.0f * DEG_TO_RAD;
+  float dec = decDegrees * DEG_TO_RAD;
+  float v[3] = { cos(dec) * cos(ra), cos(dec) * sin(ra), sin(dec) };
+
+  float r[3];
+  for (int i = 0; i < 3; i++) {
+    r[i] = _matrix[i][0] * v[0] + _matrix[i][1] * v[1] + _matrix[i][2] * v[2] + _aberration[i];
+  }
+
+  raHours = atan2(r[1], r[0]) * RAD_TO_DEG / 15.0f;
+  if (raHours < 0) {
+    raHours += 24.0f;
+  }
+  decDegrees = atan2(r[2], sqrt(r[0] * r[0] + r[1] * r[1])) * RAD_TO_DEG;
+}
+
+#else
+/////////////////////////////////
+//
+// setDate
+//
+/////////////////////////////////
+void Precession::setDate(int year, int month, int day) {
+  _years = daysSinceJ2000(year, month, day) / 365.25f;
+}
+
+/////////////////////////////////
+//
+// toDate
+//
+// The yearly precession in RA is m + n sin(RA) tan(DEC) seconds of time and in DEC n cos(RA) seconds of arc
+// (Meeus 21.1), with m = 3.075s, n = 1.336s (20.04"). Nutation and aberration are left out.
+/////////////////////////////////
+void Precession::toDate(float& raHours, float& decDegrees) const {
+  float ra = raHours * 15.0f * DEG_TO_RAD;
+  float dec = decDegrees * DEG_TO_RAD;
+  raHours += (3.075f + 1.336f * sin(ra) * tan(dec)) * _years / 3600.0f;
+  decDegrees += 20.04f * cos(ra) * _years / 3600.0f;
+  if (raHours < 0) {
+    raHours += 24.0f;
+  }
+  if (raHours >= 24.0f) {
+    raHours -= 24.0f;
+  }
+}
+#endif
@@ -0,0 +1,41 @@
+#ifndef _PRECESSION_HPP_
+#define _PRECESSION_HPP_
+
+#include <Arduino.h>
+#include "Globals.h"
+
+//////////////////////////////////////////////////////////////////
+//
+// Class that moves J2000 catalogue coordinates to where the stars are on a date (JNow). It applies
+// precession (IAU 1976), the main terms of nutation and annual aberration, which is good to about
+// a second of arc this century.
+//
+// All of that is one rotation matrix (and one aberration offset) for a date, so it is only worked
+// out when the date changes. Moving a coordinate is then a 3x3 multiply, plus the conversions to and
+// from a vector. Until a date is set, the date the firmware was built is used.
+//
+// That needs SUPPORT_PRECESSION. Without it, only the yearly rates of precession are applied, which is
+// good to an arcminute or two (close to the pole) for the next few decades, and is much smaller.
+//
+//////////////////////////////////////////////////////////////////
+class Precession {
+public:
+  Precession();
+
+  // Set the date to move coordinates to. Only works out the matrix again if the date changed.
+  void setDate(int year, int month, int day);
+
+  // Move the given J2000 RA (hours) and DEC (degrees) to the date.
+  void toDate(float& raHours, float& decDegrees) const;
+
+private:
+#ifdef SUPPORT_PRECESSION
+  long _days;
+  float _matrix[3][3];
+  float _aberration[3];
+#else
+  float _years;
+#endif
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef _STEPPERDRIVERS_HPP_
+#define _STEPPERDRIVERS_HPP_
+
+#include <Arduino.h>
+#include "Globals.h"
+#include "InterruptStepper.hpp"
+
+#define HALFSTEP 8
+#define FULLSTEP 4
+
+// The driver boards that the steppers can be connected to, see RA_DRIVER and DEC_DRIVER in Globals.h
+#define DRIVER_ULN2003 0
+#define DRIVER_STEPDIR 1
+
+//////////////////////////////////////////////////////////////////
+//
+// Driver for a 4-wire stepper (28BYJ-48) on a ULN2003 board, in HALFSTEP or FULLSTEP mode. Each
+// step writes the coil pattern for the new motor position to the four pins.
+//
+//////////////////////////////////////////////////////////////////
+template <byte Pin1, byte Pin2, byte Pin3, byte Pin4, byte StepMode>
+class CoilDriver {
+public:
+  static void begin() {
+    pinMode(Pin1, OUTPUT);
+    pinMode(Pin2, OUTPUT);
+    pinMode(Pin3, OUTPUT);
+    pinMode(Pin4, OUTPUT);
+  }
+
+  static void step(int8_t direction, long motorPosition) {
+    // The coil patterns for the 4 pins. Fullstep uses every other (two coils on) halfstep pattern.
+    static const byte halfStepCoils[8] = { B0001, B0101, B0100, B0110, B0010, B1010, B1000, B1001 };
+    byte phase = (byte)motorPosition;
+    byte coils = (StepMode == HALFSTEP) ? halfStepCoils[phase & 7] : halfStepCoils[((phase & 3) << 1) + 1];
+    digitalWrite(Pin1, (coils & B0001) ? HIGH : LOW);
+    digitalWrite(Pin2, (coils & B0010) ? HIGH : LOW);
+    digitalWrite(Pin3, (coils & B0100) ? HIGH : LOW);
+    digitalWrite(Pin4, (coils & B1000) ? HIGH : LOW);
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+//
+// Driver for a step/dir board (A4988, DRV8825, TMC2209, ...). Each (micro)step sets the direction pin
+// and pulses the step pin. The microsteps per full step are part of the mount geometry (see
+// MountGeometry.hpp). Set Reversed to make the motor turn the other way.
+//
+//////////////////////////////////////////////////////////////////
+template <byte StepPin, byte DirPin, bool Reversed>
+class StepDirDriver {
+public:
+  static void begin() {
+    pinMode(StepPin, OUTPUT);
+    pinMode(DirPin, OUTPUT);
+  }
+
+  static void step(int8_t direction, long motorPosition) {
+    // A digitalWrite() takes a few us, which is more than the setup time and pulse width these drivers need.
+    digitalWrite(DirPin, ((direction > 0) != Reversed) ? HIGH : LOW);
+    digitalWrite(StepPin, HIGH);
+    digitalWrite(StepPin, LOW);
+  }
+};
+
+//////////////////////////////////////////////////////////////////
+//
+// A stepper that drives the motor through the given driver. The driver (and its pins) are known at
+// compile time, so the timer interrupt calls it directly instead of through a pointer.
+//
+//////////////////////////////////////////////////////////////////
+template <class Driver>
+class StepperAxis : public InterruptStepper {
+public:
+  // Set up the driver pins. Call from setup().
+  void begin() {
+    Driver::begin();
+  }
+
+  // Advance by one timer tick and drive the motor. Called from the timer interrupt only.
+  void service() {
+    int8_t step = tick();
+    if (step != 0) {
+      Driver::step(step, _motorPosition);
+    }
+  }
+};
+
+// Service both steppers. Called from the timer interrupt only.
+template <class RAAxis, class DECAxis>
+inline void serviceSteppers(RAAxis& stepperRA, DECAxis& stepperDEC) {
+#ifdef DEBUG_MODE
+  unsigned long start = micros();
+#endif
+  stepperRA.service();
+  stepperDEC.service();
+#ifdef DEBUG_MODE
+  InterruptStepper::recordTickDuration(micros() - start);
+#endif
+}
+
+#endif
@@ -46,3 +46,210 @@ float clamp(float current, float minVal, float maxVal)
   if (current < minVal) current = minVal;
   return current;
 }
+
+// Divide the numerator by the denominator, returning the result as a 0.32 fixed point fraction.
+// The numerator must be smaller than the denominator. This is plain binary long division, so the
+// result is exact (truncated) and the intermediate values never need more than 64 bits.
+uint32_t fixedPointFraction(uint64_t numerator, uint64_t denominator)
+{
+  uint32_t result = 0;
+  for (byte i = 0; i < 32; i++) {
+    numerator <<= 1;
+    result <<= 1;
+    if (numerator >= denominator) {
+      numerator -= denominator;
+      result |= 1;
+    }
+  }
+  return result;
+}
+
+// The trig tables split a quarter turn into TRIG_TABLE_SIZE steps and interpolate between them. Their angles
+// are kept in units of 2^24 per turn, which is as fine as a float can tell them apart.
+#define TRIG_TABLE_SIZE 256
+#define TRIG_QUARTER_TURN 0x400000L
+#define TRIG_UNITS_PER_RADIAN 2670176.85f
+
+// The sine of each step of a quarter turn, scaled to 65535.
+const uint16_t sineTable[TRIG_TABLE_SIZE + 1] PROGMEM = {
+      0,   402,   804,  1206,  1608,  2010,  2412,  2814,  3216,  3617,  4019,  4420,  4821,  5222,  5623,  6023,
+   6424,  6824,  7223,  7623,  8022,  8421,  8820,  9218,  9616, 10014, 10411, 10808, 11204, 11600, 11996, 12391,
+  12785, 13179, 13573, 13966, 14359, 14751, 15142, 15533, 15924, 16313, 16703, 17091, 17479, 17866, 18253, 18639,
+  19024, 19408, 19792, 20175, 20557, 20939, 21319, 21699, 22078, 22456, 22834, 23210, 23586, 23960, 24334, 24707,
+  25079, 25450, 25820, 26189, 26557, 26925, 27291, 27656, 28020, 28383, 28745, 29106, 29465, 29824, 30181, 30538,
+  30893, 31247, 31600, 31952, 32302, 32651, 32999, 33346, 33692, 34036, 34379, 34721, 35061, 35400, 35738, 36074,
+  36409, 36743, 37075, 37406, 37736, 38064, 38390, 38715, 39039, 39361, 39682, 40001, 40319, 40635, 40950, 41263,
+  41575, 41885, 42194, 42500, 42806, 43109, 43411, 43712, 44011, 44308, 44603, 44897, 45189, 45479, 45768, 46055,
+  46340, 46624, 46905, 47185, 47464, 47740, 48014, 48287, 48558, 48827, 49095, 49360, 49624, 49885, 50145, 50403,
+  50659, 50913, 51166, 51416, 51664, 51911, 52155, 52398, 52638, 52877, 53113, 53348, 53580, 53811, 54039, 54266,
+  54490, 54713, 54933, 55151, 55367, 55582, 55794, 56003, 56211, 56417, 56620, 56822, 57021, 57218, 57413, 57606,
+  57797, 57985, 58171, 58356, 58537, 58717, 58895, 59070, 59243, 59414, 59582, 59749, 59913, 60075, 60234, 60391,
+  60546, 60699, 60850, 60998, 61144, 61287, 61429, 61567, 61704, 61838, 61970, 62100, 62227, 62352, 62475, 62595,
+  62713, 62829, 62942, 63053, 63161, 63267, 63371, 63472, 63571, 63668, 63762, 63853, 63943, 64030, 64114, 64196,
+  64276, 64353, 64428, 64500, 64570, 64638, 64703, 64765, 64826, 64883, 64939, 64992, 65042, 65090, 65136, 65179,
+  65219, 65258, 65293, 65327, 65357, 65386, 65412, 65435, 65456, 65475, 65491, 65504, 65515, 65524, 65530, 65534,
+  65535
+};
+
+// The arc tangent of each step from 0 to 1, as a fraction of a quarter PI scaled to 65535.
+const uint16_t arctanTable[TRIG_TABLE_SIZE + 1] PROGMEM = {
+      0,   326,   652,   978,  1304,  1630,  1955,  2281,  2607,  2932,  3258,  3583,  3908,  4234,  4559,  4884,
+   5208,  5533,  5857,  6182,  6506,  6830,  7153,  7477,  7800,  8123,  8446,  8768,  9090,  9412,  9734, 10055,
+  10376, 10697, 11018, 11338, 11658, 11977, 12296, 12615, 12933, 13251, 13569, 13886, 14203, 14519, 14835, 15151,
+  15466, 15780, 16095, 16408, 16722, 17034, 17347, 17659, 17970, 18281, 18591, 18901, 19210, 19519, 19827, 20134,
+  20441, 20748, 21054, 21359, 21664, 21968, 22272, 22575, 22877, 23179, 23480, 23780, 24080, 24379, 24678, 24976,
+  25273, 25570, 25866, 26161, 26456, 26750, 27043, 27335, 27627, 27918, 28209, 28499, 28788, 29076, 29363, 29650,
+  29936, 30222, 30506, 30790, 31074, 31356, 31638, 31919, 32199, 32478, 32757, 33035, 33312, 33588, 33864, 34138,
+  34412, 34685, 34958, 35229, 35500, 35770, 36040, 36308, 36576, 36842, 37108, 37374, 37638, 37902, 38164, 38426,
+  38688, 38948, 39207, 39466, 39724, 39981, 40237, 40493, 40747, 41001, 41254, 41506, 41758, 42008, 42258, 42507,
+  42755, 43002, 43248, 43494, 43738, 43982, 44225, 44468, 44709, 44950, 45189, 45428, 45666, 45904, 46140, 46376,
+  46611, 46844, 47078, 47310, 47541, 47772, 48002, 48231, 48459, 48687, 48913, 49139, 49364, 49588, 49812, 50034,
+  50256, 50477, 50697, 50916, 51135, 51353, 51569, 51786, 52001, 52215, 52429, 52642, 52854, 53066, 53276, 53486,
+  53695, 53903, 54111, 54317, 54523, 54728, 54932, 55136, 55339, 55541, 55742, 55943, 56142, 56341, 56540, 56737,
+  56934, 57130, 57325, 57519, 57713, 57906, 58098, 58290, 58481, 58671, 58860, 59048, 59236, 59423, 59610, 59795,
+  59980, 60165, 60348, 60531, 60713, 60895, 61075, 61255, 61435, 61613, 61791, 61968, 62145, 62321, 62496, 62670,
+  62844, 63017, 63190, 63362, 63533, 63703, 63873, 64042, 64211, 64378, 64546, 64712, 64878, 65043, 65208, 65372,
+  65535
+};
+
+// Get the sine of an angle in trig table units, scaled to 65535. The table only covers the first
+// quarter turn, the others mirror it.
+static long tableSine(long angle)
+{
+  long position = angle & (TRIG_QUARTER_TURN - 1);
+  byte quadrant = (angle >> 22) & 3;
+  if (quadrant & 1) {
+    position = TRIG_QUARTER_TURN - position;
+  }
+
+  // 8 bits of table step and 14 bits between the steps
+  int index = position >> 14;
+  long value = pgm_read_word(&sineTable[index]);
+  if (index < TRIG_TABLE_SIZE) {
+    long next = pgm_read_word(&sineTable[index + 1]);
+    value += ((next - value) * (position & 0x3FFF) + 0x2000) >> 14;
+  }
+  return (quadrant & 2) ? -value : value;
+}
+
+// Fast sine of an angle in radians (within +-800), from a table in flash.
+float fastSin(float radians)
+{
+  return tableSine((long)(radians * TRIG_UNITS_PER_RADIAN)) * (1.0f / 65535.0f);
+}
+
+// Fast cosine of an angle in radians (within +-800), from a table in flash.
+float fastCos(float radians)
+{
+  return tableSine((long)(radians * TRIG_UNITS_PER_RADIAN) + TRIG_QUARTER_TURN) * (1.0f / 65535.0f);
+}
+
+// Fast arc tangent of y / x in radians (-PI to PI), from a table in flash. The table covers the angles up to
+// a quarter PI, which is the smaller side over the larger one. The other angles mirror those.
+float fastAtan2(float y, float x)
+{
+  float absX = fabs(x);
+  float absY = fabs(y);
+  if ((absX == 0.0f) && (absY == 0.0f)) {
+    return 0.0f;
+  }
+
+  // 8 bits of table step and 16 bits between the steps
+  bool steep = absY > absX;
+  long position = (long)((steep ? absX / absY : absY / absX) * 16777216.0f);
+  int index = position >> 16;
+  long value = pgm_read_word(&arctanTable[index]);
+  if (index < TRIG_TABLE_SIZE) {
+    long next = pgm_read_word(&arctanTable[index + 1]);
+    value += ((next - value) * (position & 0xFFFF) + 0x8000) >> 16;
+  }
+
+  float angle = value * (float)(PI / 4 / 65535.0);
+  if (steep) {
+    angle = HALF_PI - angle;
+  }
+  if (x < 0.0f) {
+    angle = PI - angle;
+  }
+  return (y < 0.0f) ? -angle : angle;
+}
+
+// Get the cross product of two vectors.
+void crossProduct(const float a[3], const float b[3], float result[3])
+{
+  result[0] = a[1] * b[2] - a[2] * b[1];
+  result[1] = a[2] * b[0] - a[0] * b[2];
+  result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+#ifdef SUPPORT_KING_RATE
+// Move the given hour angle (hours) and declination (degrees) to where atmospheric refraction makes that
+// point appear, as seen from the given latitude (degrees, negative is south). Refraction lifts the point
+// towards the zenith by at most a degree, so this adds that small step along the direction of the zenith
+// (the parallactic angle) to the given position. Since only the step comes from the fast trig tables, their
+// error is a tiny part of it, and the difference between two nearby points (like the King rate needs) stays exact.
+void refractHADEC(float& hourAngle, float& declination, float latitude)
+{
+  float ha = hourAngle * 15.0f * DEG_TO_RAD;
+  float dec = declination * DEG_TO_RAD;
+  float lat = latitude * DEG_TO_RAD;
+  float sinLat = fastSin(lat);
+  float cosLat = fastCos(lat);
+  float sinDec = fastSin(dec);
+  float cosDec = fastCos(dec);
+  float cosHA = fastCos(ha);
+
+  // The direction of the zenith, as cos(altitude) times the sine and cosine of the parallactic angle.
+  float zenithHA = fastSin(ha) * cosLat;
+  float zenithDEC = sinLat * cosDec - cosLat * sinDec * cosHA;
+  float sinAltitude = sinDec * sinLat + cosDec * cosLat * cosHA;
+  float cosAltitude = sqrt(zenithHA * zenithHA + zenithDEC * zenithDEC);
+
+  // Saemundsson's formula gives the refraction (in arcminutes) for the true altitude. Below the
+  // horizon it is held at its value for -1 degree, where the formula stops making sense.
+  float altitude = fastAtan2(sinAltitude, cosAltitude) * RAD_TO_DEG;
+  float clamped = max(altitude, -1.0f);
+  float angle = (clamped + 10.3f / (clamped + 5.11f)) * DEG_TO_RAD;
+  float refraction = 1.02f / 60.0f * fastCos(angle) / fastSin(angle);
+
+  // At the zenith there is no direction, but no refraction either. Within about half a degree of the pole
+  // the hour angle hardly moves the point, so it is left alone there.
+  if (cosAltitude > 0.0f) {
+    float step = refraction / cosAltitude;
+    declination += zenithDEC * step;
+    if (cosDec > 0.01f) {
+      hourAngle -= zenithHA * step / cosDec / 15.0f;
+    }
+  }
+}
+#endif
+
+// Get the number of days from 2000-01-01 to the given date (2000 to 2099).
+long daysSinceJ2000(int year, int month, int day)
+{
+  static const int daysBeforeMonth[] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+  int years = year - 2000;
+  long days = years * 365L + (years + 3) / 4 + daysBeforeMonth[month - 1] + day - 1;
+  if ((years % 4 == 0) && (month > 2)) {
+    days++;
+  }
+  return days;
+}
+
+// Get the Greenwich mean sidereal time, in hundredths of a second, at the given UTC date (2000 to 2099) and
+// time in hundredths of a second. The time can be outside of 0 to 24 hours, it then counts from that date.
+long greenwichSiderealTime(int year, int month, int day, long utcUnits)
+{
+  long days = daysSinceJ2000(year, month, day);
+
+  // GMST = 6.697374558h + 0.06570982441908h * D0 + 1.00273790935 * UT, where D0 is the number of days from
+  // 2000-01-01 12:00 UT to 0:00 UT on the date (which is days - 0.5). This is done in hundredths of a second
+  // scaled by 10^4, so that the day term keeps its precision all century.
+  const int64_t unitsPerDayE4 = 8640000LL * 10000;
+  int64_t gmstE4 = 23992270725LL + days * 236555368LL + (int64_t)utcUnits * 100273790935LL / 10000000LL;
+  gmstE4 %= unitsPerDayE4;
+  if (gmstE4 < 0) {
+    gmstE4 += unitsPerDayE4;
+  }
+  return (long)(gmstE4 / 10000);
+}
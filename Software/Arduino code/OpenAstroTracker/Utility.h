@@ -195,6 +195,35 @@ long clamp(long current, long minVal, long maxVal);
 // Limits are inclusive, so they represent the lowest and highest valid number.
 float clamp(float current, float minVal, float maxVal);
 
+// Divide the numerator by the denominator, returning the result as a 0.32 fixed point fraction.
+// The numerator must be smaller than the denominator.
+uint32_t fixedPointFraction(uint64_t numerator, uint64_t denominator);
+
+// Fast sine and cosine of an angle in radians (within +-800), from a table in flash. They only take integer
+// maths and two table reads besides the conversions, and are off by less than 2e-5 (about 4 arcseconds).
+float fastSin(float radians);
+float fastCos(float radians);
+
+// Fast arc tangent of y / x in radians (-PI to PI), like atan2(), from a table in flash. The angle is off by
+// less than 1.3e-5 radians (under 3 arcseconds).
+float fastAtan2(float y, float x);
+
+// Get the cross product of two vectors.
+void crossProduct(const float a[3], const float b[3], float result[3]);
+
+#ifdef SUPPORT_KING_RATE
+// Move the given hour angle (hours) and declination (degrees) to where atmospheric refraction makes that
+// point appear, as seen from the given latitude (degrees, negative is south).
+void refractHADEC(float& hourAngle, float& declination, float latitude);
+#endif
+
+// Get the number of days from 2000-01-01 to the given date (2000 to 2099).
+long daysSinceJ2000(int year, int month, int day);
+
+// Get the Greenwich mean sidereal time, in hundredths of a second, at the given UTC date (2000 to 2099) and
+// time in hundredths of a second. The time can be outside of 0 to 24 hours, it then counts from that date.
+long greenwichSiderealTime(int year, int month, int day, long utcUnits);
+
 // Read the LCD Shield's key state and return the button being pressed (btnUP, etc.).
 //int read_LCD_buttons();
 
@@ -1,16 +1,12 @@
 // If you really want to look through this code, i apologise for my terrible coding
 //#include <SoftwareSerial.h>
 #include <EEPROM.h>
-#include <AccelStepper.h>
 #include <LiquidCrystal.h>
 
 #include "Utility.h"
 #include "DayTime.hpp"
 #include "Mount.hpp"
-
-
-#define HALFSTEP 8
-#define FULLSTEP 4
+#include "StepperDrivers.hpp"
 
 //SoftwareSerial BT(10,11);
 
@@ -26,6 +22,33 @@
 #define DECmotorPin3  16    // IN3 auf ULN2003 driver 2
 #define DECmotorPin4  18    // IN4 auf ULN2003 driver 2
 
+// Step/dir driver pins, if RA_DRIVER or DEC_DRIVER are DRIVER_STEPDIR (see Globals.h)
+#define RAStepPin    2      // STEP on driver 1
+#define RADirPin     3      // DIR on driver 1
+#define DECStepPin  15      // STEP on driver 2
+#define DECDirPin   17      // DIR on driver 2
+
+// The steppers. The timer interrupt below drives them through these drivers.
+#if RA_DRIVER == DRIVER_STEPDIR
+typedef StepDirDriver<RAStepPin, RADirPin, false> RADriver;
+#else
+typedef CoilDriver<RAmotorPin1, RAmotorPin2, RAmotorPin3, RAmotorPin4, HALFSTEP> RADriver;
+#endif
+
+// DEC runs the other way around
+#if DEC_DRIVER == DRIVER_STEPDIR
+typedef StepDirDriver<DECStepPin, DECDirPin, true> DECDriver;
+#else
+typedef CoilDriver<DECmotorPin4, DECmotorPin3, DECmotorPin2, DECmotorPin1, HALFSTEP> DECDriver;
+#endif
+
+StepperAxis<RADriver> stepperRA;
+StepperAxis<DECDriver> stepperDEC;
+
+ISR(TIMER1_COMPA_vect) {
+  serviceSteppers(stepperRA, stepperDEC);
+}
+
 // Menu IDs
 #define RA_Menu 0
 #define DEC_Menu 1
@@ -50,16 +73,18 @@ bool inStartup = false;        // Start with a guided startup
 bool inSerialControl = false; // When the serial port is in control
 bool quitSerialOnNextButtonRelease = false; // Used to detect SELECT button to quit Serial mode.
 
+// The J2000 RA (hours) and DEC (degrees) of Polaris, see OpenAstroTracker.ino
+float polarisRA = PolarisRAHour + PolarisRAMinute / 60.0f + PolarisRASecond / 3600.0f;
+float polarisDEC = PolarisDECDegree + PolarisDECMinute / 60.0f + PolarisDECSecond / 3600.0f;
+
 // Calibration variables
+#define MAX_BACKLASH 1000    // The most steps of backlash that we accept (from EEPROM or serial)
 float inputcal;              // calibration variable set form as integer. Added to speed after dividing by 10000
 int calDelay = 150;          // The current delay in ms when changing calibration value. The longer a button is depressed, the smaller this gets.
 
 //// Variables for use in the CONTROL menu
 bool inControlMode = false;  // Is manual control enabled
 
-// Global variables
-bool isUnreachable = false;
-
 // RA variables
 int RAselect;
 
@@ -2,7 +2,7 @@
 LcdMenu lcdMenu(16, 2, MAXMENUITEMS);
 LcdButtons lcdButtons(0);
 
-Mount mount(RAStepsPerDegree, DECStepsPerDegree, &lcdMenu);
+Mount mount(&lcdMenu);
 
 void setup() {
 
@@ -28,19 +28,50 @@ void setup() {
   pinMode(A4, OUTPUT);
 
   // Configure the mount
-  // Set the global HA correction
+  // Set the global HA correction, from the RA of Polaris on the date the firmware was built
+  float polarisRANow = polarisRA;
+  float polarisDECNow = polarisDEC;
+  mount.precessToDate(polarisRANow, polarisDECNow);
   DayTime polaris = DayTime(24, 0, 0);
-  polaris.subtractTime(DayTime(PolarisRAHour, PolarisRAMinute, PolarisRASecond));
+  polaris.subtractTime(DayTime(polarisRANow));
   mount.setHACorrection(polaris.getHours(), polaris.getMinutes(), polaris.getSeconds());
 
   // Set the stepper motor parameters
-  mount.configureRAStepper(FULLSTEP, RAmotorPin1, RAmotorPin2, RAmotorPin3, RAmotorPin4, RAspeed, RAacceleration);
-  mount.configureDECStepper(HALFSTEP, DECmotorPin1, DECmotorPin2, DECmotorPin3, DECmotorPin4, DECspeed, DECacceleration);
+  stepperRA.begin();
+  stepperDEC.begin();
+  mount.configureRAStepper(&stepperRA);
+  mount.configureDECStepper(&stepperDEC);
+  InterruptStepper::startTimer();
 
   // Read persisted values and set in mount
   inputcal = EEPROM.read(0) + EEPROM.read(3) * 256;
   DayTime haTime = DayTime(EEPROM.read(1), EEPROM.read(2), 0);
   mount.setSpeedCalibration(speed + inputcal / 10000);
+
+  // Backlash is stored as 16 bit values. An erased EEPROM reads 0xFFFF, so use the default then.
+  unsigned int backlash = EEPROM.read(4) + EEPROM.read(5) * 256;
+  mount.setBacklash(WEST, (backlash <= MAX_BACKLASH) ? backlash : RABacklash);
+  backlash = EEPROM.read(6) + EEPROM.read(7) * 256;
+  mount.setBacklash(NORTH, (backlash <= MAX_BACKLASH) ? backlash : DECBacklash);
+
+  // Keep the axes away from where they could cause damage
+  mount.setLimits(WEST, -RAStepperLimit, RAStepperLimit);
+  mount.setLimits(NORTH, DECStepperUpLimit, DECStepperDownLimit);
+
+#ifdef SUPPORT_KING_RATE
+  // The latitude is stored in minutes from the south pole. Erased EEPROM reads 0xFFFF, so use the default then.
+  unsigned int latitude = EEPROM.read(75) + EEPROM.read(76) * 256;
+  mount.setLatitude((latitude <= 10800) ? (latitude - 5400.0f) / 60.0f : Latitude);
+#endif
+
+  // Guide rates are stored as a byte of tenths. Erased EEPROM reads 0xFF, so use the default then.
+  byte guideRate = EEPROM.read(73);
+  mount.setGuideRate(WEST, (guideRate >= MIN_GUIDE_RATE && guideRate <= MAX_GUIDE_RATE) ? guideRate : RAGuideRate);
+  guideRate = EEPROM.read(74);
+  mount.setGuideRate(NORTH, (guideRate >= MIN_GUIDE_RATE && guideRate <= MAX_GUIDE_RATE) ? guideRate : DECGuideRate);
+#ifdef SUPPORT_PEC
+  mount.loadPEC();
+#endif
 #ifdef DEBUG_MODE
   Serial.println("InputCal: " + String(inputcal));
   Serial.println("SpeedCal: " + String(mount.getSpeedCalibration(), 5));
@@ -5,22 +5,24 @@ struct PointOfInterest {
   byte hourRA;
   byte minRA;
   byte secRA;
-  byte degreeDEC;
+  int8_t degreeDEC;
   byte minDEC;
   byte secDEC;
 };
 
+// The coordinates are J2000, they are moved to the date when selected. A negative DEC
+// degree makes the minutes and seconds negative too.
 PointOfInterest pointOfInterest[] = {
   //    Name (15chars)    RA (hms)     DEC (dms)
   //  012345678901234
-  { ">Polaris"        ,  PolarisRAHour, PolarisRAMinute, PolarisRASecond,  89, 21,  2 },
-  { ">Big Dipper"     , 12, 16, 26,   56, 55,  7 },
-  { ">M31 Andromeda"  ,  0, 43, 52,   41, 22, 53 },
-  { ">M42 Orion Nbula",  5, 36, 18,   -5, 22, 44 },
-  { ">M51 Whirlpool"  , 13, 30, 45,   47, 05, 21 },
-  { ">M63 Sunflower"  , 13, 16, 45,   41, 55, 14 },
-  { ">M81 Bodes Galxy",  9, 57, 13,   68, 58,  1 },
-  { ">M101 Pinwheel",   14,  3, 56,   54, 15,  0 },
+  { ">Polaris"        ,  PolarisRAHour, PolarisRAMinute, PolarisRASecond,  PolarisDECDegree, PolarisDECMinute, PolarisDECSecond },
+  { ">Big Dipper"     , 12, 15, 26,   57,  1, 57 },
+  { ">M31 Andromeda"  ,  0, 42, 44,   41, 16,  9 },
+  { ">M42 Orion Nbula",  5, 35, 17,   -5, 23, 28 },
+  { ">M51 Whirlpool"  , 13, 29, 53,   47, 11, 43 },
+  { ">M63 Sunflower"  , 13, 15, 49,   42,  1, 45 },
+  { ">M81 Bodes Galxy",  9, 55, 33,   69,  3, 55 },
+  { ">M101 Pinwheel",   14,  3, 13,   54, 20, 57 },
   // Add new items above here, not below.
   { ">Home"           ,  0,  0,  0,   90,  0,  0 },
   { ">Park"           ,  0,  0,  0,   90,  0,  0 },
@@ -45,10 +47,9 @@ bool processPOIKeys() {
         }
         else {
           PointOfInterest* poi = &pointOfInterest[currentPOI];
-          mount.targetRA().set(poi->hourRA, poi->minRA, poi->secRA);
-          mount.targetRA().addTime(mount.getHACorrection());
-          mount.targetRA().subtractTime(mount.HA());
-          mount.targetDEC().set(poi->degreeDEC - (NORTHERN_HEMISPHERE ? 90 : -90), poi->minDEC, poi->secDEC); // internal DEC degree is 0 at celestial poles
+          float ra = poi->hourRA + poi->minRA / 60.0f + poi->secRA / 3600.0f;
+          float dec = abs(poi->degreeDEC) + poi->minDEC / 60.0f + poi->secDEC / 3600.0f;
+          mount.setTargetJ2000(ra, (poi->degreeDEC < 0) ? -dec : dec);
           mount.startSlewingToTarget();
         }
       }
@@ -16,10 +16,11 @@
 // Speed calibration only has one state, allowing you to adjust the speed with UP and DOWN
 #define SPEED_CALIBRATION 7
 
-// Drift calibration goes through 4 states
+// Drift calibration goes through 2 states
 // 8 - Display four durations and wait for the user to select one
-// 9 - Start the calibration run after user presses SELECT. This state waits 1.5s, takes duration time
+// 9 - The calibration run, started after user presses SELECT. The mount waits 1.5s, takes duration time
 //     to slew east in half the time selected, then waits 1.5s and slews west in the same duration, and waits 1.5s.
+//     This runs in the background. SELECT or RIGHT cancels it.
 #define DRIFT_CALIBRATION_WAIT 18
 #define DRIFT_CALIBRATION_RUNNING 9
 
@@ -69,30 +70,9 @@ bool processCalibrationKeys() {
     }
   }
   else if (calState == DRIFT_CALIBRATION_RUNNING) {
-    lcdMenu.setCursor(0, 1);
-    lcdMenu.printMenu("Pause 1.5s ...");
-    mount.stopSlewing(TRACKING);
-    mount.delay(1500);
-
-    lcdMenu.setCursor(0, 1);
-    lcdMenu.printMenu("Eastward pass...");
-    mount.runDriftAlignmentPhase(EAST, driftDuration);
-
-    lcdMenu.setCursor(0, 1);
-    lcdMenu.printMenu("Pause 1.5s ...");
-    mount.delay(1500);
-
-    lcdMenu.setCursor(0, 1);
-    lcdMenu.printMenu("Westward pass...");
-    mount.runDriftAlignmentPhase(WEST, driftDuration);
-
-    lcdMenu.setCursor(0, 1);
-    lcdMenu.printMenu("Done. Pause 1.5s");
-    mount.delay(1500);
-    mount.runDriftAlignmentPhase(0, 0);
-
-    mount.startSlewing(TRACKING);
-    calState = HIGHLIGHT_DRIFT;
+    if (!mount.isDriftAligning()) {
+      calState = HIGHLIGHT_DRIFT;
+    }
   }
 
   if (checkForKeyChange && lcdButtons.keyChanged(key)) {
@@ -104,8 +84,7 @@ bool processCalibrationKeys() {
         if (key == btnSELECT) {
           lcdMenu.printMenu("Aligned, homing");
           mount.delay(600);
-          mount.setTargetToHome();
-          mount.startSlewingToTarget();
+          mount.startSlewingToHome();
           calState = POLAR_CALIBRATION_WAIT_HOME;
         }
         if (key == btnRIGHT) {
@@ -141,10 +120,7 @@ bool processCalibrationKeys() {
 
           // Move the RA to that of Polaris. Moving to this RA aligns the DEC axis such that
           // it swings along the line between Polaris and the Celestial Pole.
-          mount.targetRA() = DayTime(PolarisRAHour, PolarisRAMinute, PolarisRASecond);
-          // Account for the current settings.
-          mount.targetRA().addTime(mount.getHACorrection());
-          mount.targetRA().subtractTime(mount.HA());
+          mount.setTargetJ2000(polarisRA, polarisDEC);
 
           // Now set DEC to move to Home position
           mount.targetDEC() = DegreeTime(90 - (NORTHERN_HEMISPHERE ? 90 : -90), 0, 0);
@@ -162,7 +138,10 @@ bool processCalibrationKeys() {
 
           // RA is already set. Now set DEC to move the same distance past Polaris as
           // it is from the Celestial Pole. That equates to 88deg 42' 6".
-          mount.targetDEC() = DegreeTime(89 - (NORTHERN_HEMISPHERE ? 90 : -90), 21, 3);
+          float ra = polarisRA;
+          float dec = polarisDEC;
+          mount.precessToDate(ra, dec);
+          mount.targetDEC() = DegreeTime(dec - (NORTHERN_HEMISPHERE ? 90 : -90));
           mount.startSlewingToTarget();
         }
         else if (key == btnRIGHT) {
@@ -206,6 +185,7 @@ bool processCalibrationKeys() {
           // These are the times for one way. So total time is 2 x duration + 4.5s
           int duration[] = { 27, 57, 87, 147 };
           driftDuration = duration[driftSubIndex];
+          mount.startDriftAlignment(driftDuration, DriftAlignmentSteps);
           calState = DRIFT_CALIBRATION_RUNNING;
         }
         else if (key == btnRIGHT) {
@@ -215,6 +195,14 @@ bool processCalibrationKeys() {
         }
       }
       break;
+
+      case DRIFT_CALIBRATION_RUNNING: {
+        // SELECT and RIGHT cancel the run, which moves RA back and turns tracking back on
+        if (key == btnSELECT || key == btnRIGHT) {
+          mount.stopDriftAlignment(true);
+        }
+      }
+      break;
     }
   }
 
@@ -248,6 +236,16 @@ void printCalibrationSubmenu()
     scratchBuffer[driftSubIndex * 4] = '>';
     lcdMenu.printMenu(scratchBuffer);
   }
+  else if (calState == DRIFT_CALIBRATION_RUNNING) {
+    switch (mount.driftAlignmentPhase()) {
+      case DRIFT_PAUSE_START:
+      case DRIFT_PAUSE_MIDDLE: lcdMenu.printMenu("Pause 1.5s ..."); break;
+      case DRIFT_EAST: lcdMenu.printMenu("Eastward pass..."); break;
+      case DRIFT_WEST: lcdMenu.printMenu("Westward pass..."); break;
+      case DRIFT_PAUSE_END: lcdMenu.printMenu("Done. Pause 1.5s"); break;
+      case DRIFT_RETURNING: lcdMenu.printMenu("Cancelling..."); break;
+    }
+  }
   else if (calState == HIGHLIGHT_DRIFT) {
     lcdMenu.printMenu(">Drift alignment");
   }
@@ -26,8 +26,23 @@
 //      Synchronize Declination and Right Ascension.
 //      This tells the scope what it is currently pointing at.
 //      The scope synchronizes to the current target coordinates (set with :Sd# and :Sr#)
+//      This also clears the alignment model, if there is one (see :CA#).
 //      Returns: NONE#
 //
+// -- SYNC CONTROL Extensions --
+// :CA#
+//      Add Alignment Star (only with SUPPORT_ALIGNMENT)
+//      This tells the scope that it is centered on the current target (set with :Sd# and :Sr#).
+//      The first star syncs RA like :CM#. From the second star on, every slew is corrected
+//      with a model of how the axes are off (polar misalignment, cone error), solved from the last
+//      3 stars. Stars that are far apart (and not all on one line across the sky) work best.
+//      Returns: n# where n is the number of stars the model is solved from (0 after the first star)
+//
+// :CC#
+//      Clear Alignment (only with SUPPORT_ALIGNMENT)
+//      This stops correcting slews and forgets the alignment stars.
+//      Returns: 1
+//
 //------------------------------------------------------------------
 // GET FAMILY
 //
@@ -41,23 +56,64 @@
 //
 // :Gd#
 //      Get Target Declination
-//      Where s is + or -, DD is degrees, MM is minutes, SS is seconds.
-//      Returns: sDD*MM'SS
+//      Where s is + or -, DD is degrees, MM is minutes, SS is seconds, S is tenths of seconds.
+//      Returns: sDD*MM'SS, or sDD*MM'SS.S in high precision (see :U#)
 //
 // :GD#
 //      Get Current Declination
-//      Where s is + or -, DD is degrees, MM is minutes, SS is seconds.
-//      Returns: sDD*MM'SS
+//      Where s is + or -, DD is degrees, MM is minutes, SS is seconds, S is tenths of seconds.
+//      Returns: sDD*MM'SS, or sDD*MM'SS.S in high precision (see :U#)
 //
 // :Gr#
 //      Get Target Right Ascension
-//      Where HH is hour, MM is minutes, SS is seconds.
-//      Returns: HH:MM:SS
+//      Where HH is hour, MM is minutes, SS is seconds, S is tenths of seconds.
+//      Returns: HH:MM:SS, or HH:MM:SS.S in high precision (see :U#)
 //
 // :GR#
 //      Get Current Right Ascension
-//      Where HH is hour, MM is minutes, SS is seconds.
-//      Returns: HH:MM:SS
+//      Where HH is hour, MM is minutes, SS is seconds, S is tenths of seconds.
+//      Returns: HH:MM:SS, or HH:MM:SS.S in high precision (see :U#)
+//
+// :Gm#
+//      Get Pier Side
+//      East is the normal pointing state, west is with DEC turned past the pole.
+//      Returns: E# or W#
+//
+// :GT#
+//      Get Tracking Rate
+//      Where TT.T is the rate in Hz, in the model where 60.0 Hz turns RA once in 24 hours (sidereal is 60.2).
+//      Returns: TT.T#
+//
+// :Gt#
+//      Get Site Latitude (only with SUPPORT_KING_RATE)
+//      Where s is + or -, DD is degrees, MM is minutes.
+//      Returns: sDD*MM#
+//
+// :Gg#
+//      Get Site Longitude
+//      Where s is + or -, DDD is degrees west, MM is minutes.
+//      Returns: sDDD*MM#
+//
+// :GG#
+//      Get UTC Offset
+//      Where sHH.H is the number of hours to add to the local time to get UTC.
+//      Returns: sHH.H#
+//
+// :GL#
+//      Get Local Time
+//      Where HH is hours, MM is minutes, SS is seconds.
+//      Returns: HH:MM:SS#
+//
+// :GC#
+//      Get Local Date
+//      Where MM is the month, DD is the day, YY is the year.
+//      Returns: MM/DD/YY#
+//
+// :GS#
+//      Get Local Sidereal Time
+//      This is the RA on the meridian, which the mount keeps up to date itself.
+//      Where HH is hours, MM is minutes, SS is seconds.
+//      Returns: HH:MM:SS#
 //
 // -- GET Extensions --
 // :GIS#
@@ -72,6 +128,37 @@
 //      Get Guiding
 //      Returns: 1 if currently guiding. 0 if not.
 //
+// :GBR#
+// :GBD#
+//      Get Backlash
+//      Get the number of steps of slack in the RA (R) or DEC (D) gears.
+//      Returns: nnnn#
+//
+// :GIL#
+//      Get Limits
+//      The axes slow down and stop at their travel limits. This gets which limits an axis is at.
+//      Returns: a string with E or W if RA and N or S if DEC is at a limit, or 0 if none.
+//
+// :GIJ#
+//      Get Job
+//      Parking, going home and stopping run in the background. This gets which one is still running.
+//      Returns: P if parking, H if going home, S if stopping, 0 if none.
+//
+// :GID#
+//      Get Slew Duration
+//      Both axes are planned to arrive at the same time. This gets the time the slew was planned
+//      to take and how much of that is left.
+//      Where TTT.T is the total and RRR.R the remaining time in seconds.
+//      Returns: TTT.T,RRR.R#
+//
+// :GIA#
+//      Get Alignment (only with SUPPORT_ALIGNMENT)
+//      This gets the alignment model (see :CA#), to judge how well the mount is aligned.
+//      Where n is the number of stars the model is solved from (0 if there is none), UUU.U and WWW.W are how
+//      many arcminutes the celestial pole is from the RA axis, towards the zenith and towards the west, and
+//      SSS.S is how many arcminutes the axes are off square (cone error and such, or measuring error).
+//      Returns: n,UUU.U,WWW.W,SSS.S#
+//
 // :GX#
 //      Get Mount Status
 //      Returns: string reflecting the mounts' status
@@ -80,17 +167,47 @@
 // SET FAMILY
 //
 // :SdsDD*MM:SS#
+// :SdsDD*MM:SS.S#
 //      Set Target Declination
 //      This sets the target DEC. Use a Movement command to slew there.
-//      Where s is + or -, DD is degrees, MM is minutes, SS is seconds.
+//      Where s is + or -, DD is degrees, MM is minutes, SS is seconds, S is tenths of seconds.
 //      Returns: 1 if successfully set, otherwise 0
 //
 // :SrHH:MM:SS#
+// :SrHH:MM:SS.S#
 //      Set Right Ascension
 //      This sets the target RA. Use a Movement command to slew there.
+//      Where HH is hours, MM is minutes, SS is seconds, S is tenths of seconds.
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :StsDD*MM#
+//      Set Site Latitude (only with SUPPORT_KING_RATE)
+//      This sets (and stores) the latitude, which the King tracking rate needs.
+//      Where s is + or -, DD is degrees, MM is minutes.
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :SgsDDD*MM#
+//      Set Site Longitude
+//      Where s is + or - (optional), DDD is degrees west (0 to 360), MM is minutes.
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :SGsHH.H#
+//      Set UTC Offset
+//      Where sHH.H is the number of hours to add to the local time to get UTC.
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :SLHH:MM:SS#
+//      Set Local Time
 //      Where HH is hours, MM is minutes, SS is seconds.
 //      Returns: 1 if successfully set, otherwise 0
 //
+// :SCMM/DD/YY#
+//      Set Local Date
+//      Once the local date and time are set (and the longitude and UTC offset), the mount works out the
+//      local sidereal time and sets HA from it, so HA does not need to be entered.
+//      Where MM is the month, DD is the day, YY is the year (2000 to 2099).
+//      Returns: 1Updating Planetary Data#                              # if successfully set, otherwise 0
+//
 // -- SET Extensions --
 // :SHHH:MM#
 //      Set Hour Time (HA)
@@ -98,10 +215,36 @@
 //      Where HH is hours, MM is minutes.
 //      Returns: 1 if successfully set, otherwise 0
 //
+// :SBRnnnn#
+// :SBDnnnn#
+//      Set Backlash
+//      This sets (and stores) the number of steps of slack in the RA (R) or DEC (D) gears. The
+//      steppers take these up whenever they reverse.
+//      Where nnnn is the number of steps (0 to 1000).
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :STTT.TTT#
+//      Set custom Tracking rate
+//      This sets the rate used by :TM#, and switches to it.
+//      Where TT.TTT is the rate in Hz, in the model where 60.0 Hz turns RA once in 24 hours (sidereal is 60.164).
+//      Returns: 1 if successfully set, otherwise 0
+//
 // :SYsDD*MM:SS.HH:MM:SS#
+// :SYsDD*MM:SS.S.HH:MM:SS.S#
 //      Synchronize Declination and Right Ascension.
 //      This tells the scope what it is currently pointing at.
-//      Where s is + or -, DD is degrees, HH is hours, MM is minutes, SS is seconds.
+//      Where s is + or -, DD is degrees, HH is hours, MM is minutes, SS is seconds, S is tenths of seconds.
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :SdsDD*MM:SS,J#
+// :SdsDD*MM:SS.S,J#
+// :SrHH:MM:SS,J#
+// :SrHH:MM:SS.S,J#
+//      Set Target Declination or Right Ascension in J2000
+//      Like :Sd# and :Sr#, but for catalogue coordinates of epoch J2000. These are moved to the local
+//      date (see :SC#) with precession, nutation and aberration. Since that moves both together, each
+//      of these sets both targets, from the last J2000 RA and DEC that were given.
+//      Where s is + or -, DD is degrees, HH is hours, MM is minutes, SS is seconds, S is tenths of seconds.
 //      Returns: 1 if successfully set, otherwise 0
 //
 //------------------------------------------------------------------
@@ -110,7 +253,7 @@
 // :MS#
 //      Start Slew to Target (Asynchronously)
 //      This starts slewing the scope to the target RA and DEC coordinates and returns immediately.
-//      Returns: 1
+//      Returns: 1 if the slew was started, 0 if the target is outside the travel limits
 //
 // -- MOVEMENT Extensions --
 //
@@ -118,8 +261,17 @@
 //      Run a Guide pulse
 //      This runs the motors for a short period of time.
 //      Where d is one of 'N', 'E', 'W', or 'S' and nnnn is the duration in ms.
+//      An RA (E/W) and a DEC (N/S) pulse can run at the same time. Ignored while slewing.
 //      Returns: nothing
 //
+// :MDddd#
+// :MDddd,sssss#
+//      Run a Drift alignment
+//      This starts a drift alignment in the background: after a pause, RA moves east and then back west,
+//      each taking the given duration, then tracking resumes. Use :Q# to cancel it.
+//      Where ddd is the duration of one pass in seconds and sssss the number of steps to move (optional).
+//      Returns: 1
+//
 // :MTs#
 //      Set Tracking mode
 //      This turns the scopes tracking mode on or off.
@@ -133,6 +285,7 @@
 //      Park Scope and stop motors
 //      This slews the scope back to it's home position (RA ring centered, DEC
 //      at 90, basically pointing at celestial pole) and stops all movement (including tracking).
+//      This returns immediately. Use :GIJ# to see when parking is done.
 //      Returns: Nothing
 //
 // -- PARK Extensions --
@@ -142,12 +295,92 @@
 //      Returns: Nothing
 //
 //------------------------------------------------------------------
+// PEC FAMILY (only with SUPPORT_PEC)
+//
+// :pR#
+//      Record Periodic Error
+//      This starts recording RA guide pulses for a few turns of the RA motor. Once done, the average
+//      correction is stored and played back.
+//      Returns: 1
+//
+// :pP#
+//      Play back Periodic Error Correction
+//      Returns: 1 if a recorded correction is played back, otherwise 0
+//
+// :pS#
+//      Stop recording or playing back Periodic Error Correction
+//      Returns: 1
+//
+// :pG#
+//      Get PEC state
+//      Returns: 0 if off, 1 if recording, 2 if playing back
+//
+//------------------------------------------------------------------
+// RATE FAMILY
+//
+// -- RATE Extensions --
+// :RGRd.d#
+// :RGDd.d#
+//      Set Guide Rate
+//      This sets (and stores) how fast the RA (R) or DEC (D) axis moves during a guide pulse. RA guides
+//      on top of tracking, so at 1.0 the RA motor runs at twice the tracking speed (west) or stops (east).
+//      Where d.d is the rate as a fraction of the sidereal rate, from 0.1 to 1.0.
+//      Returns: 1 if successfully set, otherwise 0
+//
+// :RGR#
+// :RGD#
+//      Get Guide Rate
+//      Returns: d.d#
+//
+//------------------------------------------------------------------
+// TRACKING RATE FAMILY
+//
+// :TQ#
+//      Track at the sidereal rate
+//      Returns: nothing
+//
+// :TL#
+//      Track at the lunar rate
+//      Returns: nothing
+//
+// :TS#
+//      Track at the solar rate
+//      Returns: nothing
+//
+// :TM#
+//      Track at the custom rate set with :STTT.TTT#
+//      Returns: nothing
+//
+// -- TRACKING RATE Extensions --
+// :TK#
+//      Track at the King rate (only with SUPPORT_KING_RATE)
+//      This follows the stars as refraction shows them, which matters most close to the horizon.
+//      RA and DEC rates are updated every few seconds, for the latitude set with :StsDD*MM#.
+//      Returns: nothing
+//
+// :TG#
+//      Get Tracking Rate mode
+//      The numbers are the ASCOM DriveRates.
+//      Returns: 0 for sidereal, 1 for lunar, 2 for solar, 3 for King, 4 for custom.
+//
+//------------------------------------------------------------------
+// PRECISION FAMILY
+//
+// :U#
+//      Toggle high precision
+//      This switches the coordinates that the Get commands return between whole seconds (the
+//      default) and tenths of seconds. The Set commands always accept both.
+//      Returns: nothing
+//
+//------------------------------------------------------------------
 // QUIT MOVEMENT FAMILY
 //
 // :Q#
 //      Stop all motors
 //      This stops all motors, including tracking. Note that deceleration curves are still followed.
-//      Returns: 1 when all motors have stopped.
+//      A drift alignment in progress is cancelled, and RA moves back to where it started.
+//      This returns immediately. Use :GIJ# to see when the motors have stopped.
+//      Returns: 1
 //
 // -- QUIT MOVEMENT Extensions --
 // :Qq#
@@ -157,6 +390,51 @@
 //
 /////////////////////////////////////////////////////////////////////////////////////////
 
+// The sidereal rate in the Meade tracking rate model, where 60.0 Hz turns RA once in 24 hours.
+const float siderealHz = 60.164f;
+
+// Whether the Get commands return coordinates with tenths of seconds, toggled with :U#
+bool preciseCoordinates = false;
+
+// The last J2000 RA (hours) and DEC (degrees) set with :Sr,J# and :Sd,J#
+float catalogRA = 0;
+float catalogDEC = 0;
+
+// Read an RA of HH:MM:SS or HH:MM:SS.S into the given time. Returns false if it is neither.
+bool parseMeadeRA(String coord, DayTime& ra) {
+  //  0123456789
+  //  04:03:02.5
+  bool hasTenths = (coord.length() == 10) && (coord[8] == '.');
+  if (((coord.length() != 8) && !hasTenths) || (coord[2] != ':') || (coord[5] != ':')) {
+    return false;
+  }
+
+  long tenths = hasTenths ? coord.substring(9, 10).toInt() : 0;
+  ra.setTotalUnits(coord.substring(0, 2).toInt() * TIME_UNITS_PER_HOUR + coord.substring(3, 5).toInt() * TIME_UNITS_PER_MINUTE
+                   + coord.substring(6, 8).toInt() * TIME_UNITS_PER_SECOND + tenths * (TIME_UNITS_PER_SECOND / 10));
+  return true;
+}
+
+// Read a DEC of sDD*MM:SS or sDD*MM:SS.S into the given degrees (which are 0 at the pole). The seconds
+// may also follow a ', like :GD# returns them. Returns false if it is neither.
+bool parseMeadeDEC(String coord, DegreeTime& dec) {
+  //  01234567890
+  //  +84*03:02.5
+  bool hasTenths = (coord.length() == 11) && (coord[9] == '.');
+  if (((coord.length() != 9) && !hasTenths) || (coord[3] != '*') || ((coord[6] != ':') && (coord[6] != '\''))) {
+    return false;
+  }
+
+  long tenths = hasTenths ? coord.substring(10, 11).toInt() : 0;
+  long units = coord.substring(1, 3).toInt() * TIME_UNITS_PER_HOUR + coord.substring(4, 6).toInt() * TIME_UNITS_PER_MINUTE
+               + coord.substring(7, 9).toInt() * TIME_UNITS_PER_SECOND + tenths * (TIME_UNITS_PER_SECOND / 10);
+  if (coord[0] == '-') {
+    units = -units;
+  }
+  dec.setTotalUnits(units + (NORTHERN_HEMISPHERE ? -90L : 90L) * TIME_UNITS_PER_HOUR);
+  return true;
+}
+
 /////////////////////////////
 // INIT
 /////////////////////////////
@@ -174,6 +452,7 @@ void handleMeadeInit(String inCmd) {
 void handleMeadeGetInfo(String inCmd) {
   char cmdOne = inCmd[0];
   char cmdTwo = (inCmd.length() > 1) ? inCmd[1] : '\0';
+  byte coordFormat = preciseCoordinates ? MEADE_PRECISE_STRING : MEADE_STRING;
 
   switch (cmdOne) {
     case 'V': {
@@ -188,22 +467,76 @@ void handleMeadeGetInfo(String inCmd) {
     break;
 
     case 'r': {
-      Serial.print(mount.RAString(MEADE_STRING | TARGET_STRING));
+      Serial.print(mount.RAString(coordFormat | TARGET_STRING));
     }
     break;
 
     case 'd': {
-      Serial.print(mount.DECString(MEADE_STRING | TARGET_STRING));
+      Serial.print(mount.DECString(coordFormat | TARGET_STRING));
     }
     break;
 
     case 'R': {
-      Serial.print(mount.RAString(MEADE_STRING | CURRENT_STRING));
+      Serial.print(mount.RAString(coordFormat | CURRENT_STRING));
     }
     break;
 
     case 'D': {
-      Serial.print(mount.DECString(MEADE_STRING | CURRENT_STRING));
+      Serial.print(mount.DECString(coordFormat | CURRENT_STRING));
+    }
+    break;
+
+    case 'm': {
+      Serial.print(mount.pierSide() == PIER_SIDE_WEST ? "W#" : "E#");
+    }
+    break;
+
+    case 'T': {
+      Serial.print(String(mount.getTrackingRateFactor() * siderealHz, 1) + "#");
+    }
+    break;
+
+#ifdef SUPPORT_KING_RATE
+    case 't': {
+      int minutes = (int)(fabs(mount.getLatitude()) * 60.0f + 0.5f);
+      char latitude[10];
+      sprintf(latitude, "%c%02d*%02d#", (mount.getLatitude() < 0) ? '-' : '+', minutes / 60, minutes % 60);
+      Serial.print(latitude);
+    }
+    break;
+#endif
+
+    case 'g': {
+      // The mount has east positive, Meade has west.
+      int minutes = (int)(fabs(mount.getLongitude()) * 60.0f + 0.5f);
+      char longitude[10];
+      sprintf(longitude, "%c%03d*%02d#", (mount.getLongitude() > 0) ? '-' : '+', minutes / 60, minutes % 60);
+      Serial.print(longitude);
+    }
+    break;
+
+    case 'G': {
+      float offset = mount.getUTCOffset();
+      Serial.print(String((offset < 0) ? "-" : "+") + ((fabs(offset) < 10) ? "0" : "") + String(fabs(offset), 1) + "#");
+    }
+    break;
+
+    case 'L': {
+      Serial.print(mount.localTime().ToString() + "#");
+    }
+    break;
+
+    case 'C': {
+      int year, month, day;
+      char date[10];
+      mount.getLocalDate(year, month, day);
+      sprintf(date, "%02d/%02d/%02d#", month, day, year % 100);
+      Serial.print(date);
+    }
+    break;
+
+    case 'S': {
+      Serial.print(mount.localSiderealTime().ToString() + "#");
     }
     break;
 
@@ -212,6 +545,11 @@ void handleMeadeGetInfo(String inCmd) {
     }
     break;
 
+    case 'B': {
+      Serial.print(String(mount.getBacklash(cmdTwo == 'D' ? NORTH : WEST)) + "#");
+    }
+    break;
+
     case 'I': {
       if (cmdTwo == 'S') {
         Serial.print(mount.isSlewingRAorDEC() ? "1" : "0");
@@ -222,6 +560,28 @@ void handleMeadeGetInfo(String inCmd) {
       else if (cmdTwo == 'G') {
         Serial.print(mount.isGuiding() ? "1" : "0");
       }
+      else if (cmdTwo == 'L') {
+        int limits = mount.atLimit();
+        String axes;
+        if (limits & EAST) axes += "E";
+        if (limits & WEST) axes += "W";
+        if (limits & NORTH) axes += "N";
+        if (limits & SOUTH) axes += "S";
+        Serial.print(axes.length() > 0 ? axes : "0");
+      }
+      else if (cmdTwo == 'J') {
+        Serial.print(mount.isParking() ? "P" : mount.isFindingHome() ? "H" : mount.isStopping() ? "S" : "0");
+      }
+      else if (cmdTwo == 'D') {
+        Serial.print(String(mount.slewDuration(), 1) + "," + String(mount.slewTimeRemaining(), 1));
+      }
+#ifdef SUPPORT_ALIGNMENT
+      else if (cmdTwo == 'A') {
+        float poleUp, poleWest, skew;
+        mount.getAlignmentErrors(poleUp, poleWest, skew);
+        Serial.print(String(mount.alignmentStars()) + "," + String(poleUp, 1) + "," + String(poleWest, 1) + "," + String(skew, 1));
+      }
+#endif
       Serial.print("#");
     }
     break;
@@ -233,10 +593,20 @@ void handleMeadeGetInfo(String inCmd) {
 /////////////////////////////
 void handleMeadeSyncControl(String inCmd) {
   if (inCmd[0] == 'M') {
-    mount.syncDEC(mount.targetDEC().getHours(), mount.targetDEC().getMinutes(), mount.targetDEC().getSeconds());
-    mount.syncRA(mount.targetRA().getHours(), mount.targetRA().getMinutes(), mount.targetRA().getSeconds());
+    mount.syncDEC(mount.targetDEC());
+    mount.syncRA(mount.targetRA());
     Serial.print("NONE#");
   }
+#ifdef SUPPORT_ALIGNMENT
+  else if (inCmd[0] == 'A') {
+    mount.addAlignmentStar();
+    Serial.print(String(mount.alignmentStars()) + "#");
+  }
+  else if (inCmd[0] == 'C') {
+    mount.clearAlignment();
+    Serial.print("1");
+  }
+#endif
   else {
     Serial.print("0");
   }
@@ -246,20 +616,70 @@ void handleMeadeSyncControl(String inCmd) {
 // SET INFO
 /////////////////////////////
 void handleMeadeSetInfo(String inCmd) {
+  if ((inCmd[0] == 'T') && (inCmd.length() > 1)) {
+    // Set custom tracking rate
+    //   0123456
+    // :ST60.164
+    float hz = inCmd.substring(1).toFloat();
+    if ((hz > 50.0f) && (hz < 70.0f)) {
+      mount.setCustomTrackingRate(hz / siderealHz);
+      mount.setTrackingRateMode(TRACKING_CUSTOM);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+    return;
+  }
+
+  if ((inCmd[0] == 'G') && (inCmd.length() > 1)) {
+    // Set UTC offset
+    //   012345
+    // :SG+05.0
+    float hours = inCmd.substring(1).toFloat();
+    if (fabs(hours) <= 14.0f) {
+      mount.setUTCOffset(hours);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+    return;
+  }
+
   if (inCmd.length() < 6) {
     Serial.print("0");
     return;
   }
 
-  if ((inCmd[0] == 'd') && (inCmd.length() == 10)) {
+  if (((inCmd[0] == 'd') || (inCmd[0] == 'r')) && inCmd.endsWith(",J")) {
+    // Set DEC or RA in J2000
+    //   0123456789012
+    // :Sd+84*03:02,J
+    // :Sr04:03:02,J
+    String coord = inCmd.substring(1, inCmd.length() - 2);
+    DegreeTime dec;
+    DayTime ra;
+    if ((inCmd[0] == 'd') && parseMeadeDEC(coord, dec)) {
+      catalogDEC = dec.getTotalDegrees() + (NORTHERN_HEMISPHERE ? 90 : -90);
+    }
+    else if ((inCmd[0] == 'r') && parseMeadeRA(coord, ra)) {
+      catalogRA = ra.getTotalHours();
+    }
+    else {
+      // Did not understand the coordinate
+      Serial.print("0");
+      return;
+    }
+    mount.setTargetJ2000(catalogRA, catalogDEC);
+    Serial.print("1");
+  }
+  else if (inCmd[0] == 'd') {
     // Set DEC
     //   0123456789
     // :Sd+84*03:02
-    int sgn = inCmd[1] == '+' ? 1 : -1;
-    if ((inCmd[4] == '*') && (inCmd[7] == ':'))
+    if (parseMeadeDEC(inCmd.substring(1), mount.targetDEC()))
     {
-      int deg = inCmd.substring(2, 4).toInt();
-      mount.targetDEC().set(sgn * deg + (NORTHERN_HEMISPHERE ? -90 : 90), inCmd.substring(5, 7).toInt(), inCmd.substring(8, 10).toInt());
       Serial.print("1");
     }
     else {
@@ -267,13 +687,14 @@ void handleMeadeSetInfo(String inCmd) {
       Serial.print("0");
     }
   }
-  else if (inCmd[0] == 'r' && (inCmd.length() == 9)) {
+  else if (inCmd[0] == 'r') {
     // Set RA
     //   012345678
     // :Sr04:03:02
-    if ((inCmd[3] == ':') && (inCmd[6] == ':'))
+    DayTime ra;
+    if (parseMeadeRA(inCmd.substring(1), ra))
     {
-      mount.targetRA().set(inCmd.substring(1, 3).toInt(), inCmd.substring(4, 6).toInt(), inCmd.substring(7, 9).toInt());
+      mount.targetRA() = ra;
       mount.targetRA().addTime(mount.getHACorrection());
       mount.targetRA().subtractTime(mount.HA());
       Serial.print("1");
@@ -282,6 +703,95 @@ void handleMeadeSetInfo(String inCmd) {
       // Did not understand the coordinate
       Serial.print("0");
   }
+  else if ((inCmd[0] == 'B') && (inCmd.length() == 6)) {
+    // Set backlash
+    //   012345
+    // :SBR0040
+    int steps = inCmd.substring(2, 6).toInt();
+    int address = (inCmd[1] == 'D') ? 6 : 4;
+    if (((inCmd[1] == 'R') || (inCmd[1] == 'D')) && (steps <= MAX_BACKLASH)) {
+      mount.setBacklash((inCmd[1] == 'D') ? NORTH : WEST, steps);
+      EEPROM.update(address, steps & 0x00FF);
+      EEPROM.update(address + 1, (steps & 0xFF00) >> 8);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+  }
+#ifdef SUPPORT_KING_RATE
+  else if ((inCmd[0] == 't') && (inCmd.length() == 7)) {
+    // Set latitude
+    //   0123456
+    // :St+47*36
+    int sgn = inCmd[1] == '+' ? 1 : -1;
+    int deg = inCmd.substring(2, 4).toInt();
+    int minutes = inCmd.substring(5, 7).toInt();
+    if ((inCmd[4] == '*') && (deg <= 90) && (minutes < 60)) {
+      mount.setLatitude(sgn * (deg + minutes / 60.0f));
+
+      // Stored as minutes from the south pole, so that erased EEPROM (0xFFFF) is out of range.
+      unsigned int stored = sgn * (deg * 60 + minutes) + 5400;
+      EEPROM.update(75, stored & 0x00FF);
+      EEPROM.update(76, (stored & 0xFF00) >> 8);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+  }
+#endif
+  else if ((inCmd[0] == 'g') && (inCmd.length() >= 6)) {
+    // Set longitude, in degrees west like the Meade protocol
+    //   01234567
+    // :Sg008*30
+    // :Sg-008*30
+    int start = ((inCmd[1] == '+') || (inCmd[1] == '-')) ? 2 : 1;
+    int star = inCmd.indexOf('*');
+    if ((star > start) && (star + 3 == inCmd.length())) {
+      float west = inCmd.substring(start, star).toInt() + inCmd.substring(star + 1).toInt() / 60.0f;
+      if (inCmd[1] == '-') {
+        west = -west;
+      }
+
+      // The mount has east positive, from -180 to 180.
+      float east = -west;
+      while (east < -180.0f) east += 360.0f;
+      while (east > 180.0f) east -= 360.0f;
+      mount.setLongitude(east);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+  }
+  else if (inCmd[0] == 'L') {
+    // Set local time
+    //   012345678
+    // :SL19:33:03
+    DayTime local;
+    if (parseMeadeRA(inCmd.substring(1), local)) {
+      mount.setLocalTime(local);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+  }
+  else if ((inCmd[0] == 'C') && (inCmd.length() == 9) && (inCmd[3] == '/') && (inCmd[6] == '/')) {
+    // Set local date
+    //   012345678
+    // :SC04/21/20
+    int month = inCmd.substring(1, 3).toInt();
+    int day = inCmd.substring(4, 6).toInt();
+    if ((month >= 1) && (month <= 12) && (day >= 1) && (day <= 31)) {
+      mount.setLocalDate(2000 + inCmd.substring(7, 9).toInt(), month, day);
+      Serial.print("1Updating Planetary Data#                              #");
+    }
+    else {
+      Serial.print("0");
+    }
+  }
   else if (inCmd[0] == 'H') {
     // Set HA
     int hHA = inCmd.substring(1, 3).toInt();
@@ -289,15 +799,18 @@ void handleMeadeSetInfo(String inCmd) {
     mount.setHA(DayTime(hHA, minHA, 0));
     Serial.print("1");
   }
-  else if ((inCmd[0] == 'Y') && inCmd.length() == 19) {
+  else if (inCmd[0] == 'Y') {
     // Sync RA, DEC - current position is teh given coordinate
     //   0123456789012345678
     // :SY+84*03:02.18:34:12
-    int sgn = inCmd[1] == '+' ? 1 : -1;
-    if ((inCmd[4] == '*') && (inCmd[7] == ':') && (inCmd[10] == '.') && (inCmd[13] == ':') && (inCmd[16] == ':')) {
-      int deg = inCmd.substring(2, 4).toInt();
-      mount.syncDEC(sgn * deg + (NORTHERN_HEMISPHERE ? -90 : 90), inCmd.substring(5, 7).toInt(), inCmd.substring(8, 10).toInt());
-      mount.syncRA(inCmd.substring(11, 13).toInt(), inCmd.substring(14, 16).toInt(), inCmd.substring(17, 19).toInt());
+    // :SY+84*03:02.5.18:34:12.3
+    // A '.' separates DEC from RA, so a DEC with tenths has a second one after them.
+    int raStart = ((inCmd.length() > 12) && (inCmd[10] == '.') && (inCmd[12] == '.')) ? 13 : 11;
+    DegreeTime dec;
+    DayTime ra;
+    if ((inCmd[raStart - 1] == '.') && parseMeadeDEC(inCmd.substring(1, raStart - 1), dec) && parseMeadeRA(inCmd.substring(raStart), ra)) {
+      mount.syncDEC(dec);
+      mount.syncRA(ra);
       Serial.print("1");
     }
     else {
@@ -315,7 +828,7 @@ void handleMeadeSetInfo(String inCmd) {
 void handleMeadeMovement(String inCmd) {
   if (inCmd[0] == 'S') {
     mount.startSlewingToTarget();
-    Serial.print("1");
+    Serial.print(mount.isUnreachable() ? "0" : "1");
   }
   else if (inCmd[0] == 'T') {
     if (inCmd.length() > 1) {
@@ -346,6 +859,21 @@ void handleMeadeMovement(String inCmd) {
       mount.guidePulse(direction, duration);
     }
   }
+  else if (inCmd[0] == 'D') {
+    // Drift alignment
+    //   0123456789
+    // :MD057,800
+    int comma = inCmd.indexOf(',');
+    long steps = DriftAlignmentSteps;
+    if (comma > 0) {
+      steps = inCmd.substring(comma + 1).toInt();
+    }
+    else {
+      comma = inCmd.length();
+    }
+    mount.startDriftAlignment(inCmd.substring(1, comma).toInt(), steps);
+    Serial.print("1");
+  }
   else if (inCmd[0] == 'e') {
     mount.startSlewing(EAST);
   }
@@ -372,6 +900,81 @@ void handleMeadeHome(String inCmd) {
   }
 }
 
+#ifdef SUPPORT_PEC
+/////////////////////////////
+// PEC
+/////////////////////////////
+void handleMeadePEC(String inCmd) {
+  if (inCmd[0] == 'R') {
+    mount.startPECRecording();
+    Serial.print("1");
+  }
+  else if (inCmd[0] == 'P') {
+    mount.startPECPlayback();
+    Serial.print(mount.pecStatus() == PEC_PLAYING ? "1" : "0");
+  }
+  else if (inCmd[0] == 'S') {
+    mount.stopPEC();
+    Serial.print("1");
+  }
+  else if (inCmd[0] == 'G') {
+    Serial.print(String(mount.pecStatus()) + "#");
+  }
+}
+#endif
+
+/////////////////////////////
+// RATE
+/////////////////////////////
+void handleMeadeRate(String inCmd) {
+  if ((inCmd[0] == 'G') && ((inCmd[1] == 'R') || (inCmd[1] == 'D'))) {
+    int direction = (inCmd[1] == 'D') ? NORTH : WEST;
+    if (inCmd.length() == 2) {
+      Serial.print(String(mount.getGuideRate(direction) / 10.0f, 1) + "#");
+      return;
+    }
+
+    // Set guide rate
+    //   01234
+    // :RGR0.5
+    int tenths = (int)(inCmd.substring(2).toFloat() * 10 + 0.5f);
+    if ((inCmd.length() == 5) && (inCmd[3] == '.') && (tenths >= MIN_GUIDE_RATE) && (tenths <= MAX_GUIDE_RATE)) {
+      mount.setGuideRate(direction, tenths);
+      EEPROM.update((inCmd[1] == 'D') ? 74 : 73, tenths);
+      Serial.print("1");
+    }
+    else {
+      Serial.print("0");
+    }
+  }
+  else {
+    Serial.print("0");
+  }
+}
+
+/////////////////////////////
+// TRACKING RATE
+/////////////////////////////
+void handleMeadeTrackingRate(String inCmd) {
+  switch (inCmd[0]) {
+    case 'Q': mount.setTrackingRateMode(TRACKING_SIDEREAL); break;
+    case 'L': mount.setTrackingRateMode(TRACKING_LUNAR); break;
+    case 'S': mount.setTrackingRateMode(TRACKING_SOLAR); break;
+    case 'M': mount.setTrackingRateMode(TRACKING_CUSTOM); break;
+#ifdef SUPPORT_KING_RATE
+    case 'K': mount.setTrackingRateMode(TRACKING_KING); break;
+#endif
+    case 'G': Serial.print(String(mount.getTrackingRateMode()) + "#"); break;
+  }
+}
+
+/////////////////////////////
+// PRECISION
+/////////////////////////////
+void handleMeadePrecision(String inCmd) {
+  preciseCoordinates = !preciseCoordinates;
+}
+
 /////////////////////////////
 // QUIT
 /////////////////////////////
@@ -379,8 +982,14 @@ void handleMeadeQuit(String inCmd) {
   // :Q# stops a motors - remains in Control mode
   // :Qq# command does not stop motors, but quits Control mode
   if ((inCmd.length() == 0) || (inCmd[0] != 'q')) {
-    mount.stopSlewing(ALL_DIRECTIONS | TRACKING);
-    mount.waitUntilStopped(ALL_DIRECTIONS);
+    if (mount.isDriftAligning()) {
+      // Let RA move back to where the drift alignment started.
+      mount.stopDriftAlignment(false);
+      mount.stopSlewing(NORTH | SOUTH | TRACKING);
+    }
+    else {
+      mount.stopSlewing(ALL_DIRECTIONS | TRACKING);
+    }
     Serial.print("1");
   }
   else {
@@ -419,6 +1028,12 @@ void serialEvent() {
         case 'h': handleMeadeHome(inCmd); break;
         case 'I': handleMeadeInit(inCmd); break;
         case 'Q': handleMeadeQuit(inCmd); break;
+        case 'R': handleMeadeRate(inCmd); break;
+        case 'T': handleMeadeTrackingRate(inCmd); break;
+        case 'U': handleMeadePrecision(inCmd); break;
+#ifdef SUPPORT_PEC
+        case 'p': handleMeadePEC(inCmd); break;
+#endif
       }
     }
 
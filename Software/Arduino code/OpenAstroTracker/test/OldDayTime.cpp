@@ -0,0 +1,229 @@
+#include "Utility.h"
+#include "OldDayTime.hpp"
+
+///////////////////////////////////
+// OldDayTime (and OldDegreeTime below)
+//
+// A class to handle hours, minutes, seconds in a unified manner, allowing
+// addition of hours, minutes, seconds, other times and conversion to string.
+
+OldDayTime::OldDayTime() {
+  hours = 0;
+  mins = 0;
+  secs = 0;
+}
+
+OldDayTime::OldDayTime(const OldDayTime& other) {
+  hours = other.hours;
+  mins = other.mins;
+  secs = other.secs;
+}
+
+OldDayTime::OldDayTime(int h, int m, int s) {
+  hours = h;
+  mins = m;
+  secs = s;
+}
+
+// From milliseconds. Does not handle days!
+OldDayTime::OldDayTime(long ms) {
+  ms /= 1000; // seconds
+  secs = (int)(ms % 60);
+  ms = (ms - secs) / 60;
+  mins = (int)(ms % 60);
+  ms = (ms - mins) / 60;
+  hours = (int)ms;
+}
+
+OldDayTime::OldDayTime(float timeInHours) {
+  hours = floor(timeInHours);
+  timeInHours = (timeInHours - hours) * 60;
+  mins = floor(timeInHours);
+  timeInHours = (timeInHours - mins) * 60;
+  secs = floor(timeInHours);
+}
+
+int OldDayTime::getHours() const {
+  return hours;
+}
+
+int OldDayTime::getMinutes() const {
+  return mins;
+}
+
+int OldDayTime::getSeconds() const {
+  return secs;
+}
+
+float OldDayTime::getTotalHours() const {
+  return 1.0f * getHours() + ((float)getMinutes() / 60.0f) + ((float)getSeconds() / 3600.0f);
+}
+
+float OldDayTime::getTotalMinutes() const {
+  return 60.0f * getHours() + (float)getMinutes() + ((float)getSeconds() / 60.0f);
+}
+
+float OldDayTime::getTotalSeconds() const {
+  return 3600.0f * getHours() + (float)getMinutes() * 60.0f + (float)getSeconds();
+}
+
+int OldDayTime::getTime(int& h, int& m, int& s) const {
+  h = hours;
+  m = mins;
+  s = secs;
+}
+
+void OldDayTime::set(int h, int m, int s) {
+  hours = h;
+  mins = m;
+  secs = s;
+  checkHours();
+}
+
+void OldDayTime::set(const OldDayTime& other) {
+  hours = other.hours;
+  mins = other.mins;
+  secs = other.secs;
+  checkHours();
+}
+
+// Add hours, wrapping days (which are not tracked)
+void OldDayTime::addHours(int deltaHours) {
+  hours += deltaHours;
+  checkHours();
+}
+
+void OldDayTime::checkHours() {
+  while (hours >= hourWrap) {
+    hours -= hourWrap;
+  }
+
+  while (hours < 0) {
+    hours += hourWrap;
+  }
+}
+
+// Add minutes, wrapping hours if needed
+void OldDayTime::addMinutes(int deltaMins) {
+  mins += deltaMins;
+  while (mins > 59) {
+    mins -= 60;
+    addHours(1);
+  }
+
+  while (mins < 0) {
+    mins += 60;
+    addHours(-1);
+  }
+}
+
+// Add seconds, wrapping minutes and hours if needed
+void OldDayTime::addSeconds(long deltaSecs) {
+  secs += deltaSecs;
+  while (secs > 59) {
+    secs -= 60;
+    addMinutes(1);
+  }
+
+  while (secs < 0) {
+    secs += 60;
+    addMinutes(-1);
+  }
+}
+
+// Add time components, wrapping seconds, minutes and hours if needed
+void OldDayTime::addTime(int deltaHours, int deltaMinutes, int deltaSeconds)
+{
+  addSeconds(deltaSeconds);
+  addMinutes(deltaMinutes);
+  addHours(deltaHours);
+}
+
+// Add another time, wrapping seconds, minutes and hours if needed
+void OldDayTime::addTime(const OldDayTime& other)
+{
+  addSeconds(other.getSeconds());
+  addMinutes(other.getMinutes());
+  addHours(other.getHours());
+}
+
+// Subtract another time, wrapping seconds, minutes and hours if needed
+void OldDayTime::subtractTime(const OldDayTime& other)
+{
+  addSeconds(-other.getSeconds());
+  addMinutes(-other.getMinutes());
+  addHours(-other.getHours());
+}
+
+// Convert to a standard string (like 14:45:06)
+String OldDayTime::ToString()
+{
+  char achBuf[12];
+  char* p = achBuf;
+
+  if (hours < 10) {
+    *p++ = '0';
+  }
+  else {
+    *p++ = '0' + (hours / 10);
+  }
+
+  *p++ = '0' + (hours % 10);
+
+  *p++ = ':';
+  if (mins < 10) {
+    *p++ = '0';
+  }
+  else {
+    *p++ = '0' + (mins / 10);
+  }
+
+  *p++ = '0' + (mins % 10);
+  *p++ = ':';
+  if (secs < 10) {
+    *p++ = '0';
+  }
+  else {
+    *p++ = '0' + (secs / 10);
+  }
+
+  *p++ = '0' + (secs % 10);
+  *p++ = '\0';
+  return String(achBuf);
+}
+
+
+OldDegreeTime::OldDegreeTime() : OldDayTime() {
+  hourWrap = 180;
+}
+
+OldDegreeTime::OldDegreeTime(const OldDegreeTime& other) : OldDayTime(other) { }
+OldDegreeTime::OldDegreeTime(int h, int m, int s) : OldDayTime(h, m, s) { }
+OldDegreeTime::OldDegreeTime(float inDegrees) : OldDayTime(inDegrees) { }
+
+void OldDegreeTime::addDegrees(int deltaDegrees) {
+  addHours(deltaDegrees);
+}
+
+int OldDegreeTime::getDegrees() {
+  return hours;
+}
+
+int OldDegreeTime::getPrintDegrees() {
+  return NORTHERN_HEMISPHERE ? hours + 90 : hours - 90;
+}
+
+float OldDegreeTime::getTotalDegrees() {
+  return getTotalHours();
+}
+
+void OldDegreeTime::checkHours() {
+  if (NORTHERN_HEMISPHERE) {
+    if (hours > 0) hours = 0;
+    if (hours < -180) hours = -180;
+  }
+  else {
+    if (hours > 180) hours = 180;
+    if (hours < 0) hours = 0;
+  }
+}
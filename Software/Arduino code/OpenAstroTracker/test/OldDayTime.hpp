@@ -0,0 +1,92 @@
+// DayTime and DegreeTime as they were when they kept hours, minutes and seconds as three ints, renamed so
+// that daytime_bench can compare them with the current classes.
+
+#ifndef _OLDDAYTIME_HPP_
+#define _OLDDAYTIME_HPP_
+
+#include <Arduino.h>
+#include "Globals.h"
+
+// A class to handle hours, minutes, seconds in a unified manner, allowing
+// addition of hours, minutes, seconds, other times and conversion to string.
+
+class OldDayTime {
+protected:
+  int hours;
+  int mins;
+  int secs;
+  int hourWrap = 24;
+
+public:
+  OldDayTime();
+
+  OldDayTime(const OldDayTime& other);
+  OldDayTime(int h, int m, int s);
+
+  // From milliseconds. Does not handle days!
+  OldDayTime(long ms);
+
+  // From hours
+  OldDayTime(float timeInHours);
+
+  int getHours() const;
+  int getMinutes() const;
+  int getSeconds() const;
+  float getTotalHours() const;
+  float getTotalMinutes() const;
+  float getTotalSeconds() const;
+
+  int getTime(int& h, int& m, int& s) const;
+  void set(int h, int m, int s);
+  void set(const OldDayTime& other);
+
+  // Add hours, wrapping days (which are not tracked). Negative or positive.
+  virtual void addHours(int deltaHours);
+
+  // Add minutes, wrapping hours if needed
+  void addMinutes(int deltaMins);
+
+  // Add seconds, wrapping minutes and hours if needed
+  void addSeconds(long deltaSecs);
+
+  // Add time components, wrapping seconds, minutes and hours if needed
+  void addTime(int deltaHours, int deltaMinutes, int deltaSeconds);
+
+  // Add another time, wrapping seconds, minutes and hours if needed
+  void addTime(const OldDayTime& other);
+  // Subtract another time, wrapping seconds, minutes and hours if needed
+
+  void subtractTime(const OldDayTime& other);
+
+  // Convert to a standard string (like 14:45:06)
+  String ToString();
+  //protected:
+  virtual void checkHours();
+};
+
+class OldDegreeTime : public OldDayTime {
+public:
+  OldDegreeTime();
+  OldDegreeTime(const OldDegreeTime& other);
+  OldDegreeTime(int h, int m, int s);
+  OldDegreeTime(float inDegrees);
+
+  // Add degrees, clamp at 90
+  void addDegrees(int deltaDegrees);
+
+  // Get degrees component
+  int getDegrees();
+
+  // Get degrees for printing component
+  int getPrintDegrees();
+
+  // Get total degrees
+  float getTotalDegrees();
+  //protected:
+  virtual void checkHours() override;
+
+private:
+  void clampDegrees();
+};
+
+#endif
@@ -0,0 +1,85 @@
+// Compares DayTime and DegreeTime with the classes they replaced (see OldDayTime.hpp). First it runs the same
+// random sequences of additions on both and checks that they end up at the same time. Then it times the
+// operations that the mount uses most, on this host.
+
+#include <chrono>
+#include <Arduino.h>
+#include "DayTime.hpp"
+#include "OldDayTime.hpp"
+
+#define SEQUENCES 200000
+
+volatile int intSink;
+volatile float floatSink;
+
+// Returns the average time (in ns) of one call of the given function.
+template <class Function>
+double nanosPerCall(Function function, long calls) {
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < calls; i++) {
+    function(i);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+template <class Old, class New>
+void compare(const char* name, Old oldFunction, New newFunction, long calls) {
+  double oldNanos = nanosPerCall(oldFunction, calls);
+  double newNanos = nanosPerCall(newFunction, calls);
+  printf("  %-20s %9.1f ns %9.1f ns\n", name, oldNanos, newNanos);
+}
+
+int main() {
+  srand(1);
+  int mismatches = 0;
+  for (long i = 0; i < SEQUENCES; i++) {
+    int h = rand() % 24;
+    int m = rand() % 60;
+    int s = rand() % 60;
+    long deltaSeconds = (rand() % 200001) - 100000;
+    int deltaHours = rand() % 48 - 24;
+    int deltaMinutes = rand() % 120 - 60;
+
+    OldDayTime oldTime(h, m, s);
+    DayTime newTime(h, m, s);
+    oldTime.addSeconds(deltaSeconds);
+    newTime.addSeconds(deltaSeconds);
+    oldTime.addTime(OldDayTime(deltaHours % 24, abs(deltaMinutes) % 60, 5));
+    newTime.addTime(DayTime(deltaHours % 24, abs(deltaMinutes) % 60, 5));
+    oldTime.addMinutes(deltaMinutes);
+    newTime.addMinutes(deltaMinutes);
+    if ((oldTime.getHours() != newTime.getHours()) || (oldTime.getMinutes() != newTime.getMinutes()) ||
+        (oldTime.getSeconds() != newTime.getSeconds()) || (fabs(oldTime.getTotalHours() - newTime.getTotalHours()) > 1e-5)) {
+      mismatches++;
+    }
+
+    // Away from the poles, where the old class only clamped the degrees and the new one clamps the whole value.
+    int degrees = -10 - rand() % 160;
+    OldDegreeTime oldDegrees(degrees, m, s);
+    DegreeTime newDegrees(degrees, m, s);
+    oldDegrees.addMinutes(deltaMinutes);
+    newDegrees.addMinutes(deltaMinutes);
+    if ((oldDegrees.getPrintDegrees() != newDegrees.getPrintDegrees()) ||
+        (oldDegrees.getMinutes() != newDegrees.getMinutes()) || (oldDegrees.getSeconds() != newDegrees.getSeconds())) {
+      mismatches++;
+    }
+  }
+  printf("%d random add sequences, %d mismatches\n\n", SEQUENCES, mismatches);
+
+  printf("  %-20s %12s %12s\n", "", "old", "new");
+  // After a day of tracking, setTargetToHome() adds about 86164 seconds.
+  compare("addSeconds(86164)",
+    [](long i) { OldDayTime t(1, 2, 3); t.addSeconds(86164L + i % 7); intSink = t.getSeconds(); },
+    [](long i) { DayTime t(1, 2, 3); t.addSeconds(86164L + i % 7); intSink = t.getSeconds(); }, 20000);
+  compare("addTime(DayTime)",
+    [](long i) { OldDayTime t(1, 2, 3); t.addTime(OldDayTime(5, i % 60, 59)); intSink = t.getSeconds(); },
+    [](long i) { DayTime t(1, 2, 3); t.addTime(DayTime(5, i % 60, 59)); intSink = t.getSeconds(); }, 10000000);
+  compare("DayTime(float)",
+    [](long i) { OldDayTime t((i % 2400) / 100.0f); intSink = t.getMinutes(); },
+    [](long i) { DayTime t((i % 2400) / 100.0f); intSink = t.getMinutes(); }, 10000000);
+  compare("getTotalHours()",
+    [](long i) { OldDayTime t(i % 24, 2, 3); floatSink = t.getTotalHours(); },
+    [](long i) { DayTime t(i % 24, 2, 3); floatSink = t.getTotalHours(); }, 10000000);
+
+  return mismatches;
+}
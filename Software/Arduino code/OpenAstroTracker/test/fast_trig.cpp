@@ -0,0 +1,118 @@
+// Checks the table driven fastSin(), fastCos() and fastAtan2() against libm in double precision, and
+// refractHADEC() against the exact version it replaced. Then it times them against the libm float functions,
+// on this host.
+
+#include <chrono>
+#include <Arduino.h>
+#include "Utility.h"
+
+// refractHADEC() as it was before it used the fast functions. It goes to the horizon frame, refracts the
+// altitude and comes back.
+void exactRefractHADEC(float& hourAngle, float& declination, float latitude)
+{
+  float ha = hourAngle * 15.0f * DEG_TO_RAD;
+  float dec = declination * DEG_TO_RAD;
+  float sinLat = sin(latitude * DEG_TO_RAD);
+  float cosLat = cos(latitude * DEG_TO_RAD);
+  float sinDec = sin(dec);
+  float cosDec = cos(dec);
+  float cosHA = cos(ha);
+
+  float x = sinDec * cosLat - cosDec * sinLat * cosHA;
+  float y = -cosDec * sin(ha);
+  float z = sinDec * sinLat + cosDec * cosLat * cosHA;
+  float horizontal = sqrt(x * x + y * y);
+
+  float altitude = atan2(z, horizontal) * RAD_TO_DEG;
+  float clamped = max(altitude, -1.0f);
+  float refraction = 1.02f / tan((clamped + 10.3f / (clamped + 5.11f)) * DEG_TO_RAD);
+  float apparent = (altitude + refraction / 60.0f) * DEG_TO_RAD;
+
+  float scale = (horizontal > 0.0f) ? cos(apparent) / horizontal : 0.0f;
+  x *= scale;
+  y *= scale;
+  z = sin(apparent);
+
+  hourAngle = atan2(-y, z * cosLat - x * sinLat) * RAD_TO_DEG / 15.0f;
+  declination = asin(clamp(z * sinLat + x * cosLat, -1.0f, 1.0f)) * RAD_TO_DEG;
+}
+
+volatile float sink;
+
+// Returns the average time (in ns) of one call of the given function.
+template <class Function>
+double nanosPerCall(Function function) {
+  const long calls = 2000000;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < calls; i++) {
+    sink += function(i * 1e-5f);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+int main() {
+  // Sine and cosine over four turns either way.
+  double sinError = 0, cosError = 0;
+  for (long i = -2000000; i <= 2000000; i++) {
+    double x = i * (4 * 2 * PI / 4000000.0);
+    sinError = max(sinError, fabs(fastSin(x) - sin(x)));
+    cosError = max(cosError, fabs(fastCos(x) - cos(x)));
+  }
+
+  // Arc tangent of random points, a third of them steep.
+  double atanError = 0;
+  srand(1);
+  for (long i = 0; i < 4000000; i++) {
+    float y = (rand() / (float)RAND_MAX - 0.5f) * ((i % 3) ? 2 : 2000);
+    float x = (rand() / (float)RAND_MAX - 0.5f) * 2;
+    double error = fabs(fastAtan2(y, x) - atan2((double)y, (double)x));
+    if (error > PI) {
+      error = 2 * PI - error;
+    }
+    atanError = max(atanError, error);
+  }
+  printf("Largest error against libm: sin %.1e, cos %.1e, atan2 %.1e rad\n", sinError, cosError, atanError);
+  printf("atan2 of (0,1) (1,0) (0,-1) (-1,0): %f %f %f %f\n", fastAtan2(0, 1), fastAtan2(1, 0), fastAtan2(0, -1), fastAtan2(-1, 0));
+
+  // Refraction over the sky, by altitude. The King rate is how fast the refracted hour angle moves
+  // compared to the true one, over a quarter of an hour.
+  float bands[] = { 5, 10, 15, 20, 30 };
+  printf("\nrefractHADEC() against the exact version, for latitudes -60 to 60:\n");
+  printf("  %9s %16s %16s %14s\n", "altitude", "King correction", "rate difference", "DEC difference");
+  for (float band : bands) {
+    double kingCorrection = 0, rateDifference = 0, decDifference = 0;
+    for (float latitude = -60; latitude <= 60; latitude += 15) {
+      for (float dec = -80; dec <= 85; dec += 1) {
+        for (float ha = -6; ha <= 6; ha += 0.1f) {
+          double altitude = asin(sin(dec * DEG_TO_RAD) * sin(latitude * DEG_TO_RAD) +
+                                 cos(dec * DEG_TO_RAD) * cos(latitude * DEG_TO_RAD) * cos(ha * 15 * DEG_TO_RAD)) * RAD_TO_DEG;
+          if (altitude < band) {
+            continue;
+          }
+
+          float fastHA0 = ha - 0.125f, fastDEC0 = dec, fastHA1 = ha + 0.125f, fastDEC1 = dec;
+          float exactHA0 = fastHA0, exactDEC0 = dec, exactHA1 = fastHA1, exactDEC1 = dec;
+          refractHADEC(fastHA0, fastDEC0, latitude);
+          refractHADEC(fastHA1, fastDEC1, latitude);
+          exactRefractHADEC(exactHA0, exactDEC0, latitude);
+          exactRefractHADEC(exactHA1, exactDEC1, latitude);
+
+          kingCorrection = max(kingCorrection, fabs((exactHA1 - exactHA0) / 0.25 - 1));
+          rateDifference = max(rateDifference, fabs((fastHA1 - fastHA0) - (exactHA1 - exactHA0)) / 0.25);
+          decDifference = max(decDifference, fabs((fastDEC1 - fastDEC0) - (exactDEC1 - exactDEC0)) * 3600);
+        }
+      }
+    }
+    printf("  above %2.0f %16.1e %16.1e %13.2f\"\n", band, kingCorrection, rateDifference, decDifference);
+  }
+
+  printf("\nHost time per call:\n");
+  printf("  sinf          %6.1f ns\n", nanosPerCall([](float x) { return sinf(x); }));
+  printf("  fastSin       %6.1f ns\n", nanosPerCall([](float x) { return fastSin(x); }));
+  printf("  atan2f        %6.1f ns\n", nanosPerCall([](float x) { return atan2f(x, 0.7f); }));
+  printf("  fastAtan2     %6.1f ns\n", nanosPerCall([](float x) { return fastAtan2(x, 0.7f); }));
+  printf("  exact refract %6.1f ns\n", nanosPerCall([](float x) { float ha = x, dec = 30; exactRefractHADEC(ha, dec, 47); return ha; }));
+  printf("  refractHADEC  %6.1f ns\n", nanosPerCall([](float x) { float ha = x, dec = 30; refractHADEC(ha, dec, 47); return ha; }));
+
+  return 0;
+}
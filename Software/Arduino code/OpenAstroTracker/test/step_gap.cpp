@@ -0,0 +1,138 @@
+// Measures the longest gap between the steps of a motor that runs at constant speed while the main loop is
+// busy with scripted LCD and serial work. It compares steps taken by InterruptStepper from the timer interrupt
+// with steps taken from the main loop, the way AccelStepper::runSpeed() was called from Mount::loop() before.
+//
+// Time is simulated. The main loop is a series of passes, each of which blocks for the time its work takes
+// on the Arduino. The timer interrupt still fires every tick during a pass, but runSpeed() only gets to look
+// at the clock in between passes.
+
+#include <Arduino.h>
+#include "InterruptStepper.hpp"
+
+#define TICK_MICROS (1000000UL / STEP_TIMER_FREQUENCY)
+#define RUN_MICROS 60000000UL
+
+// Rough times (in us) that the work in the main loop takes on a 16 MHz Uno.
+// A pass with nothing to do reads the buttons (one analogRead() is about 110us) and checks the mount.
+#define IDLE_PASS_MICROS 150
+// LiquidCrystal sends a character as two nibbles, each followed by a 100us settle delay. Updating a line
+// of the display is a setCursor() and 16 characters.
+#define LCD_LINE_MICROS (17 * 230)
+// A command like :GR# from a client polling the position, read at 57600 baud, parsed and answered.
+#define SERIAL_COMMAND_MICROS 1500
+// A command whose '#' got lost makes Serial.readStringUntil() wait out its one second timeout.
+#define SERIAL_TIMEOUT_MICROS 1000000UL
+
+struct Job {
+  const char* name;
+  unsigned long every;
+  unsigned long duration;
+  unsigned long next;
+};
+
+// Steps the motor from the main loop, like AccelStepper::runSpeed(). The interval is in whole microseconds.
+class LoopStepper {
+public:
+  LoopStepper(float stepsPerSecond) : _interval((unsigned long)(1000000.0f / stepsPerSecond)), _lastStep(0) {}
+
+  bool runSpeed(unsigned long now) {
+    if (now - _lastStep >= _interval) {
+      _lastStep = now;
+      return true;
+    }
+    return false;
+  }
+
+private:
+  unsigned long _interval;
+  unsigned long _lastStep;
+};
+
+struct GapStats {
+  unsigned long lastStep;
+  unsigned long maxGap;
+  long steps;
+
+  GapStats() : lastStep(0), maxGap(0), steps(0) {}
+
+  void step(unsigned long now) {
+    if (steps > 0) {
+      maxGap = max(maxGap, now - lastStep);
+    }
+    lastStep = now;
+    steps++;
+  }
+};
+
+// Runs both steppers at the given speed for RUN_MICROS under the given load.
+void run(float stepsPerSecond, Job* jobs, int jobCount, GapStats& timerStats, GapStats& loopStats) {
+  InterruptStepper stepper;
+  stepper.setSpeed(stepsPerSecond);
+  LoopStepper loopStepper(stepsPerSecond);
+
+  for (int i = 0; i < jobCount; i++) {
+    jobs[i].next = jobs[i].every;
+  }
+
+  unsigned long now = 0;
+  unsigned long nextTick = TICK_MICROS;
+  while (now < RUN_MICROS) {
+    if (loopStepper.runSpeed(now)) {
+      loopStats.step(now);
+    }
+
+    unsigned long busy = IDLE_PASS_MICROS;
+    for (int i = 0; i < jobCount; i++) {
+      if (now >= jobs[i].next) {
+        busy += jobs[i].duration;
+        jobs[i].next += jobs[i].every;
+      }
+    }
+
+    // The timer interrupt keeps firing while the pass is busy.
+    now += busy;
+    while (nextTick <= now) {
+      if (stepper.tick() != 0) {
+        timerStats.step(nextTick);
+      }
+      nextTick += TICK_MICROS;
+    }
+  }
+}
+
+int main() {
+  Job polling[] = {
+    { "LCD line", DISPLAY_UPDATE_TIME * 1000UL, LCD_LINE_MICROS, 0 },
+    { "serial command", 250000UL, SERIAL_COMMAND_MICROS, 0 },
+  };
+  Job pollingWithTimeout[] = {
+    { "LCD line", DISPLAY_UPDATE_TIME * 1000UL, LCD_LINE_MICROS, 0 },
+    { "serial command", 250000UL, SERIAL_COMMAND_MICROS, 0 },
+    { "serial timeout", 20000000UL, SERIAL_TIMEOUT_MICROS, 0 },
+  };
+
+  struct {
+    const char* name;
+    Job* jobs;
+    int jobCount;
+  } loads[] = {
+    { "LCD updates and serial polling", polling, 2 },
+    { "same, plus a lost '#' every 20s", pollingWithTimeout, 3 },
+  };
+
+  // Tracking (V1 ring), tracking plus a guide pulse, and a slew at full speed.
+  float speeds[] = { 300 * 14.95902778f / 3600.0f, 2 * 300 * 14.95902778f / 3600.0f, RA_MAX_SPEED };
+
+  printf("Worst case step gap over %lus, timer tick %luus\n", RUN_MICROS / 1000000UL, TICK_MICROS);
+  for (auto& load : loads) {
+    printf("\n%s:\n", load.name);
+    printf("  %9s %10s | %12s %9s | %12s %9s\n", "steps/s", "interval", "timer gap", "steps", "loop gap", "steps");
+    for (float speed : speeds) {
+      GapStats timerStats, loopStats;
+      run(speed, load.jobs, load.jobCount, timerStats, loopStats);
+      printf("  %9.3f %8.0fus | %10luus %9ld | %10luus %9ld\n", speed, 1000000.0f / speed,
+             timerStats.maxGap, timerStats.steps, loopStats.maxGap, loopStats.steps);
+    }
+  }
+  return 0;
+}
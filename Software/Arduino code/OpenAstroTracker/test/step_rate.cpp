@@ -0,0 +1,112 @@
+// Finds the highest step rate that each axis sustains while slewing with its ramp table. For a range of
+// maximum speeds it slews far enough to cruise for a while, then checks that the cruise rate is the speed
+// that was asked for and that the slew ends exactly on target. It also checks a range of move lengths at the
+// configured speeds, and times how long the timer interrupt takes to service both axes on this host.
+
+#include <chrono>
+#include <vector>
+#include <Arduino.h>
+#include "InterruptStepper.hpp"
+
+// How far (as a fraction) the cruise rate may be off before the speed counts as not sustained.
+#define RATE_TOLERANCE 0.001f
+
+struct Slew {
+  long position;
+  long ticks;
+  float cruiseRate;
+};
+
+// Slews from standstill to the given position and measures the step rate over one second in the middle.
+Slew slew(float maxSpeed, float acceleration, long distance) {
+  InterruptStepper stepper;
+  stepper.setMaxSpeed(maxSpeed);
+  stepper.setAcceleration(acceleration);
+  stepper.moveTo(distance);
+
+  std::vector<long> positions;
+  while (stepper.isRunning() && positions.size() < 600UL * STEP_TIMER_FREQUENCY) {
+    stepper.tick();
+    positions.push_back(stepper.currentPosition());
+  }
+
+  Slew result;
+  result.position = stepper.currentPosition();
+  result.ticks = positions.size();
+  long middle = max(0L, (long)positions.size() / 2 - STEP_TIMER_FREQUENCY / 2);
+  result.cruiseRate = positions[middle + STEP_TIMER_FREQUENCY] - positions[middle];
+  return result;
+}
+
+int main() {
+  struct {
+    const char* name;
+    float acceleration;
+  } axes[] = {
+    { "RA", RA_ACCELERATION },
+    { "DEC", DEC_ACCELERATION },
+  };
+  float speeds[] = { 400, 800, 1200, 1600, 2500, 4000, STEP_TIMER_FREQUENCY - 1 };
+  int failures = 0;
+
+  printf("Sustained slew rates, timer at %d Hz\n", STEP_TIMER_FREQUENCY);
+  for (auto& axis : axes) {
+    float highest = 0;
+    printf("\n%s (%.0f steps/s/s):\n", axis.name, axis.acceleration);
+    printf("  %8s %8s %10s %8s\n", "speed", "cruise", "target", "landed");
+    for (float speed : speeds) {
+      // Two ramps and five seconds of cruising.
+      long distance = (long)(speed * speed / axis.acceleration + 5 * speed);
+      Slew result = slew(speed, axis.acceleration, distance);
+      bool sustained = (result.position == distance) && (fabs(result.cruiseRate - speed) <= speed * RATE_TOLERANCE);
+      if (sustained) {
+        highest = speed;
+      }
+      printf("  %8.0f %8.0f %10ld %8ld%s\n", speed, result.cruiseRate, distance, result.position, sustained ? "" : "  not sustained");
+    }
+    printf("  Highest sustained rate: %.0f steps/s\n", highest);
+  }
+
+  // Moves of all lengths at the configured speeds have to land on target, in about the time of the ideal ramp.
+  long distances[] = { 1, 2, 3, 5, 10, 50, 100, 500, 1000, 5000, 20000, 100000 };
+  printf("\nMoves at the configured speeds:\n");
+  printf("  %4s %8s %8s %9s %9s\n", "axis", "distance", "landed", "time", "ideal");
+  float worstRatio = 0;
+  for (int a = 0; a < 2; a++) {
+    float maxSpeed = (a == 0) ? RA_MAX_SPEED : DEC_MAX_SPEED;
+    for (long distance : distances) {
+      InterruptStepper stepper;
+      stepper.setMaxSpeed(maxSpeed);
+      stepper.setAcceleration(axes[a].acceleration);
+      float ideal = stepper.moveDuration(distance);
+      Slew result = slew(maxSpeed, axes[a].acceleration, distance);
+      float time = (float)result.ticks / STEP_TIMER_FREQUENCY;
+      if (result.position != distance) {
+        failures++;
+      }
+      worstRatio = max(worstRatio, time / ideal);
+      printf("  %4s %8ld %8ld %8.3fs %8.3fs\n", axes[a].name, distance, result.position, time, ideal);
+    }
+  }
+  printf("  Slowest move took %.1f%% longer than the ideal ramp\n", (worstRatio - 1) * 100);
+
+  // Time the work of one timer interrupt for both axes while they slew at full speed, on this host.
+  InterruptStepper ra, dec;
+  ra.setMaxSpeed(RA_MAX_SPEED);
+  ra.setAcceleration(RA_ACCELERATION);
+  dec.setMaxSpeed(DEC_MAX_SPEED);
+  dec.setAcceleration(DEC_ACCELERATION);
+  ra.moveTo(100000000L);
+  dec.moveTo(-100000000L);
+  const long ticks = 100L * STEP_TIMER_FREQUENCY;
+  volatile int sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < ticks; i++) {
+    sink += ra.tick();
+    sink += dec.tick();
+  }
+  double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ticks;
+  printf("\nHost time to service both axes: %.1f ns per tick\n", nanos);
+
+  return failures;
+}
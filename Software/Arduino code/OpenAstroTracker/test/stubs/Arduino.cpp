@@ -0,0 +1,18 @@
+#include <Arduino.h>
+
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t OCR1A, TCNT1;
+
+HardwareSerial Serial;
+
+unsigned long fakeMicros = 0;
+
+unsigned long millis() { return fakeMicros / 1000; }
+unsigned long micros() { return fakeMicros; }
+void delay(unsigned long ms) { fakeMicros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { fakeMicros += us; }
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return LOW; }
+int analogRead(uint8_t) { return 1023; }
@@ -0,0 +1,117 @@
+#ifndef _ARDUINO_STUB_H_
+#define _ARDUINO_STUB_H_
+
+// Just enough of the Arduino core to compile the sketch's classes on the host. The clock is
+// simulated: micros() and millis() return whatever the test sets in fakeMicros.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+// The binary constants of binary.h that the coil driver uses.
+#define B0000 0
+#define B0001 1
+#define B0010 2
+#define B0011 3
+#define B0100 4
+#define B0101 5
+#define B0110 6
+#define B0111 7
+#define B1000 8
+#define B1001 9
+#define B1010 10
+#define B1011 11
+#define B1100 12
+#define B1101 13
+#define B1110 14
+#define B1111 15
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define F_CPU 16000000UL
+
+// Flash is ordinary memory on the host.
+#define PROGMEM
+#define F(x) x
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_float(p) (*(const float*)(p))
+
+// Timer1 registers, written by InterruptStepper::startTimer().
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t OCR1A, TCNT1;
+#define WGM12 3
+#define CS11 1
+#define CS10 0
+#define OCIE1A 1
+#define ISR(vector) void vector(void)
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+extern unsigned long fakeMicros;
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+class String {
+public:
+  String() {}
+  String(const char* text) : _text(text ? text : "") {}
+  String(int value) : _text(std::to_string(value)) {}
+  String(long value) : _text(std::to_string(value)) {}
+  String(unsigned long value) : _text(std::to_string(value)) {}
+  String(double value, int decimals = 2) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    _text = buf;
+  }
+
+  unsigned length() const { return _text.size(); }
+  const char* c_str() const { return _text.c_str(); }
+  String& operator+=(const String& other) { _text += other._text; return *this; }
+  String operator+(const String& other) const { String result(*this); return result += other; }
+  bool operator==(const String& other) const { return _text == other._text; }
+
+private:
+  std::string _text;
+};
+
+class HardwareSerial {
+public:
+  void begin(long) {}
+  template <class T> void print(T) {}
+  template <class T> void println(T) {}
+  void println() {}
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,56 @@
+// Tracks for 8 simulated hours at the fixed point sidereal rate, for both RA rings and a few speed calibrations.
+// It checks that the stepper took exactly the whole steps that its rate adds up to, and reports how far that
+// rate drifted from the ideal number of steps. For comparison it also shows the drift of the float rate that
+// AccelStepper turned into a step interval in whole microseconds.
+
+#include <Arduino.h>
+#include "InterruptStepper.hpp"
+#include "MountGeometry.hpp"
+#include "Utility.h"
+
+#define TRACK_HOURS 8
+
+int main() {
+  int stepsPerDegree[] = { RARing<1>::STEPS_PER_DEGREE, RARing<2>::STEPS_PER_DEGREE };
+  float calibrations[] = { 1.0f, 1.0017f, 0.9877f };
+  const long ticks = TRACK_HOURS * 3600L * STEP_TIMER_FREQUENCY;
+
+  printf("Tracking drift after %d hours, in steps\n", TRACK_HOURS);
+  printf("  %5s %7s %10s %12s %10s %10s %12s\n", "steps", "calib", "rate", "ideal", "tracked", "drift", "AccelStepper");
+
+  double worst = 0;
+  int missed = 0;
+  for (int steps : stepsPerDegree) {
+    for (float calibration : calibrations) {
+      // The same calculation as Mount::setSpeedCalibration().
+      uint32_t calibrationE4 = (uint32_t)(calibration * 10000.0f + 0.5f);
+      uint64_t stepsPerHourE11 = (uint64_t)steps * siderealDegreesInHourE7 * calibrationE4;
+      uint32_t rate = fixedPointFraction(stepsPerHourE11, 3600ULL * STEP_TIMER_FREQUENCY * 100000000000ULL);
+
+      InterruptStepper stepper;
+      stepper.setStepRate(rate, 1);
+      for (long i = 0; i < ticks; i++) {
+        stepper.tick();
+      }
+
+      double stepsPerSecond = steps * 14.95902778 * (calibrationE4 / 10000.0) / 3600.0;
+      double ideal = stepsPerSecond * TRACK_HOURS * 3600.0;
+      double tracked = (double)rate * ticks / 4294967296.0;
+      double drift = tracked - ideal;
+      worst = max(worst, fabs(drift));
+      if (stepper.currentPosition() != (long)tracked) {
+        missed++;
+      }
+
+      // AccelStepper ran at a float speed, as a step interval in whole microseconds.
+      float speed = calibration * steps * siderealDegreesInHour / 3600.0f;
+      unsigned long interval = (unsigned long)(1000000.0f / speed);
+      double floatDrift = TRACK_HOURS * 3600.0 * 1000000.0 / interval - ideal;
+
+      printf("  %5d %7.4f %10u %12.4f %10ld %10.4f %12.4f\n", steps, calibration, rate, ideal,
+             stepper.currentPosition(), drift, floatDrift);
+    }
+  }
+  printf("Largest drift: %.4f steps, runs that did not take exactly the steps of their rate: %d\n", worst, missed);
+  return missed;
+}